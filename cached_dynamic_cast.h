@@ -0,0 +1,124 @@
+#pragma once
+
+// Drop-in replacement for `dynamic_cast` that remembers results
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <typeinfo>
+
+namespace cached_dynamic_cast_detail {
+// Result of a cast as the offset from the most-derived object, or `kFailed`
+inline constexpr std::ptrdiff_t kFailed = PTRDIFF_MIN;
+
+struct Key {
+    const std::type_info* dynamic;  // typeid(*ptr)
+    const std::type_info* source;   // static type of ptr
+    const std::type_info* target;
+    std::ptrdiff_t fromTop;         // where ptr points into the most-derived object
+
+    bool operator==(const Key&) const = default;
+
+    std::size_t hash() const {
+        std::uint64_t h = reinterpret_cast<std::uintptr_t>(dynamic);
+        h = (h ^ reinterpret_cast<std::uintptr_t>(source)) * 0x9e3779b97f4a7c15ull;
+        h = (h ^ reinterpret_cast<std::uintptr_t>(target)) * 0x9e3779b97f4a7c15ull;
+        h = (h ^ static_cast<std::uint64_t>(fromTop)) * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+// Open-addressed table of cast results shared by all threads. A slot is claimed once, filled, and then published;
+// it never changes afterwards, so lookups need no locks. Keys use the addresses of the type_info objects: if a
+// type has several of them (e.g. across shared libraries), each one just gets its own entries. Keys that find no
+// free slot within `kMaxProbes` are not cached and always take the real `dynamic_cast`.
+class Table {
+ private:
+    static constexpr std::size_t kSize = 4096;
+    static constexpr std::size_t kMaxProbes = 16;
+    enum : std::uint8_t { kEmpty, kWriting, kReady };
+
+    struct Slot {
+        std::atomic<std::uint8_t> state{kEmpty};
+        Key key;
+        std::ptrdiff_t offset;
+    };
+
+    Slot slots_[kSize]{};
+
+ public:
+    bool find(const Key& key, std::size_t hash, std::ptrdiff_t& offset) const {
+        for (std::size_t i = 0; i < kMaxProbes; ++i) {
+            const Slot& slot = slots_[(hash + i) % kSize];
+            std::uint8_t state = slot.state.load(std::memory_order_acquire);
+            if (state == kEmpty) { return false; }
+            if (state == kReady && slot.key == key) {
+                offset = slot.offset;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(const Key& key, std::size_t hash, std::ptrdiff_t offset) {
+        for (std::size_t i = 0; i < kMaxProbes; ++i) {
+            Slot& slot = slots_[(hash + i) % kSize];
+            std::uint8_t state = kEmpty;
+            // Acquire on failure, as the key of a ready slot is read below; also on success, as GCC rejects a failure
+            // order stronger than the success one
+            if (slot.state.compare_exchange_strong(state, kWriting, std::memory_order_acquire)) {
+                slot.key = key;
+                slot.offset = offset;
+                slot.state.store(kReady, std::memory_order_release);
+                return;
+            }
+            // Another thread may have found the same result first
+            if (state == kReady && slot.key == key) { return; }
+        }
+    }
+};
+
+inline constinit Table table;
+}  // namespace cached_dynamic_cast_detail
+
+// Same as `dynamic_cast<Derived>(ptr)` for a pointer type Derived, but looks the result up by the most-derived type
+// of `*ptr`, the subobject `ptr` points to and the target type first; only the first cast of such a combination does
+// the real `dynamic_cast`
+template<typename Derived, typename Base>
+    requires std::is_pointer_v<Derived> && requires(Base* ptr) { dynamic_cast<Derived>(ptr); }
+Derived cached_dynamic_cast(Base* ptr)
+{
+    namespace detail = cached_dynamic_cast_detail;
+    using Bytes = const volatile char*;
+
+    if constexpr (std::is_void_v<std::remove_pointer_t<Derived>>) {
+        return dynamic_cast<Derived>(ptr);
+    } else if constexpr (std::is_convertible_v<Base*, Derived>) {
+        return ptr;
+    } else {
+        if (!ptr) { return nullptr; }
+        auto top = reinterpret_cast<Bytes>(dynamic_cast<const volatile void*>(ptr));
+        const detail::Key key{&typeid(*ptr), &typeid(Base), &typeid(std::remove_pointer_t<Derived>),
+                              reinterpret_cast<Bytes>(ptr) - top};
+        const std::size_t hash = key.hash();
+        std::ptrdiff_t offset;
+        if (!detail::table.find(key, hash, offset)) {
+            Derived result = dynamic_cast<Derived>(ptr);
+            offset = result ? reinterpret_cast<Bytes>(result) - top : detail::kFailed;
+            detail::table.insert(key, hash, offset);
+            return result;
+        }
+        return offset != detail::kFailed ? reinterpret_cast<Derived>(const_cast<char*>(top + offset)) : nullptr;
+    }
+}
+
+// Same as `dynamic_cast<Derived>(ref)` for a reference type Derived: throws `std::bad_cast` if the cast fails
+template<typename Derived, typename Base>
+    requires std::is_reference_v<Derived>
+Derived cached_dynamic_cast(Base& ref)
+{
+    auto* result = cached_dynamic_cast<std::remove_reference_t<Derived>*>(&ref);
+    if (!result) { throw std::bad_cast(); }
+    return static_cast<Derived>(*result);
+}
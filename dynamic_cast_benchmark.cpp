@@ -28,6 +28,10 @@
 */
 
 #include "vrc/rtti_base.h"
+#include "vrc/poly_vector.h"
+#include "vrc/ref.h"
+#include "vrc/type_registry.h"
+#include "cached_dynamic_cast.h"
 #include "KCL/KCL_RTTI.h"
 
 #include <iostream>
@@ -37,12 +41,35 @@
 #include <cstdlib>
 #include <typeinfo>
 #include <string>
-#include <functional>
 #include <random>
 #include <algorithm>
+#include <span>
+#include <numeric>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <thread>
+#include <barrier>
+#include <limits>
+#include <tuple>
+#include <array>
+#include <unordered_map>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 enum class Hierarchy { deep, shallow, balanced, cross };
 enum class SortOrder { aligned, shuffled };
+enum class Placement { heap, packed, clustered, scattered, padded };
 
 double max_num_ops = 0;
 
@@ -159,6 +186,36 @@ struct Z : KCL::RTTI::Base, vrc::RttiBase { KCL_RTTI_IMPL(); VRC_IMPLEMENT_DYNAM
 KCL_RTTI_REGISTER(Z);
 VRC_DECLARE_CLASS_NAME(Z);
 
+// Objects of realistic size: Bytes of cold payload between the field right after those of A, on the cache line of
+// the vptr, and the field at the far end of the object
+namespace payload {
+    template<size_t Bytes> struct B : A { KCL_RTTI_IMPL(); VRC_IMPLEMENT_DYNAMIC_CAST(A); uint64_t near{1}; std::byte cold[Bytes]{}; uint64_t far{1}; };
+    template<size_t Bytes> struct C : B<Bytes> { KCL_RTTI_IMPL(); VRC_IMPLEMENT_DYNAMIC_CAST(B<Bytes>); uint64_t c{1}; };
+    // Same as C, but final, so that casts to it take the exact-type path
+    template<size_t Bytes> struct L final : B<Bytes> { KCL_RTTI_IMPL(); VRC_IMPLEMENT_DYNAMIC_CAST(B<Bytes>); uint64_t c{1}; };
+
+    using B64 = B<64>;
+    using C64 = C<64>;
+    using L64 = L<64>;
+    using B256 = B<256>;
+    using C256 = C<256>;
+    using L256 = L<256>;
+}
+
+KCL_RTTI_REGISTER(payload::B64, A);
+KCL_RTTI_REGISTER(payload::C64, payload::B64);
+KCL_RTTI_REGISTER(payload::L64, payload::B64);
+KCL_RTTI_REGISTER(payload::B256, A);
+KCL_RTTI_REGISTER(payload::C256, payload::B256);
+KCL_RTTI_REGISTER(payload::L256, payload::B256);
+
+VRC_DECLARE_CLASS_NAME(payload::B64);
+VRC_DECLARE_CLASS_NAME(payload::C64);
+VRC_DECLARE_CLASS_NAME(payload::L64);
+VRC_DECLARE_CLASS_NAME(payload::B256);
+VRC_DECLARE_CLASS_NAME(payload::C256);
+VRC_DECLARE_CLASS_NAME(payload::L256);
+
 
 struct JustKclRtti : KCL::RTTI::Base { KCL_RTTI_IMPL(); };
 KCL_RTTI_REGISTER(JustKclRtti);
@@ -170,6 +227,13 @@ struct JustRtti : KCL::RTTI::Base, vrc::RttiBase { KCL_RTTI_IMPL(); VRC_IMPLEMEN
 KCL_RTTI_REGISTER(JustRtti);
 VRC_DECLARE_CLASS_NAME(JustRtti);
 
+// Large hierarchies below A, written by tools/hierarchy_generator for the shapes the build asks for
+#if __has_include("synthetic_hierarchies.h")
+#include "synthetic_hierarchies.h"
+#else
+using SyntheticHierarchies = std::tuple<>;
+#endif
+
 double dummy = 0;
 std::default_random_engine rng{};
 
@@ -188,294 +252,2118 @@ void draw_bar(double percent, std::string s = "-") {
     }
 }
 
-double run(std::string label, std::function<uint64_t()> benchmark)
+
+// Where the objects live; every mode but `heap` places them in `arena`, in an order that decides their layout:
+// packed      - one after the other, in the order they appear in the vector
+// clustered   - one after the other, grouped by class
+// scattered   - one after the other, in random order, so that neighbours in the vector are pages apart
+// padded      - in the order they appear in the vector, each starting on its own cache line
+Placement placement = Placement::heap;
+
+const char* const PLACEMENT_NAMES[] = { "heap", "packed", "clustered", "scattered", "padded" };
+
+constexpr size_t CACHE_LINE = 64;
+
+// Bump allocator for the benchmark objects; the memory is only released when the program exits
+class Arena {
+public:
+    void* allocate(size_t size, size_t align) {
+        void* p = next;
+        if (!p || !std::align(align, size, p, space)) {
+            chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(CHUNK_SIZE));
+            p = chunks.back().get();
+            space = CHUNK_SIZE;
+            std::align(align, size, p, space);
+        }
+        next = static_cast<std::byte*>(p) + size;
+        space -= size;
+        return p;
+    }
+
+    // Where allocation stands, to rewind to once the objects allocated since are destroyed
+    struct Mark {
+        size_t chunks;
+        std::byte* next;
+        size_t space;
+    };
+
+    Mark mark() const { return { chunks.size(), next, space }; }
+
+    void rewind(const Mark& m) {
+        chunks.resize(m.chunks);
+        next = m.next;
+        space = m.space;
+    }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 << 20;
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* next = nullptr;
+    size_t space = 0;
+};
+
+Arena arena;
+
+struct ObjectDeleter {
+    void operator()(A* p) const {
+        if (placement == Placement::heap) delete p;
+        else p->~A();
+    }
+};
+
+using ObjectPtr = std::unique_ptr<A, ObjectDeleter>;
+using Objects = std::vector<ObjectPtr>;
+
+template<typename T, typename... Args>
+ObjectPtr make_object(Args&&... args)
 {
-    auto t1 = std::chrono::high_resolution_clock::now();
-    uint64_t successes = benchmark();
-    auto t2 = std::chrono::high_resolution_clock::now();
+    if (placement == Placement::heap) return ObjectPtr(new T(std::forward<Args>(args)...));
+    size_t align = placement == Placement::padded ? CACHE_LINE : alignof(T);
+    return ObjectPtr(new (arena.allocate(sizeof(T), align)) T(std::forward<Args>(args)...));
+}
 
-    auto usecs_total =
-        std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count();
-    double num_ops = USECS_PER_SEC / (double(usecs_total) / N);
-    if (max_num_ops == 0) { max_num_ops = num_ops; } // the first run will be 100%
-    double percent = num_ops / max_num_ops;
-    printf(
-            "%3s: %6.1f MHz (%3.0f%%) [%7llu] ",
-            label.c_str(),
-            num_ops / USECS_PER_SEC,
-            percent * 100, static_cast<unsigned long long>(successes)
-          );
-    draw_bar(percent);
-    return num_ops;
+// How the class numbers of a data set are drawn: class i with a probability proportional to weights[i], rescaled
+// so that the classes `succeeds` accepts make up `success` of the objects if `success` is in [0, 1]. Each class
+// repeats for a run of geometrically distributed length, `run_length` on average, so that the stream of classes
+// ranges from a constant to a random sequence.
+struct Workload {
+    std::string name;
+    std::vector<double> weights;
+    double success = -1;
+    bool (*succeeds)(unsigned) = nullptr;
+    double run_length = 1;
+};
+
+// Weight 1 / (rank + 1)^skew for classes from, ..., from + width, ranked in that order; skew 0 is uniform
+std::vector<double> zipf_weights(unsigned from, unsigned width, double skew)
+{
+    std::vector<double> weights(from + width + 1);
+    for (unsigned i = 0; i <= width; i++) weights[from + i] = 1 / std::pow(i + 1, skew);
+    return weights;
 }
 
-std::vector<std::unique_ptr<A>> generate_data(Hierarchy h, unsigned from, unsigned width)
+std::vector<unsigned> draw_classes(const Workload& workload)
 {
-    std::vector<std::unique_ptr<A>> v;
-    v.reserve(N);
+    std::vector<double> weights = workload.weights;
+    if (workload.success >= 0 && workload.succeeds) {
+        double total[2] = {};
+        for (unsigned i = 0; i < weights.size(); i++) total[workload.succeeds(i)] += weights[i];
+        for (unsigned i = 0; i < weights.size(); i++) {
+            bool success = workload.succeeds(i);
+            if (total[success] > 0) weights[i] *= (success ? workload.success : 1 - workload.success) / total[success];
+        }
+    }
+    std::discrete_distribution<unsigned> distrib(weights.begin(), weights.end());
+    std::bernoulli_distribution new_run(1 / std::max(workload.run_length, 1.0));
+
+    std::vector<unsigned> vals(N);
+    for (uint64_t i = 0; i < N; i++) vals[i] = i == 0 || new_run(rng) ? distrib(rng) : vals[i - 1];
+    return vals;
+}
+
+// Shannon entropy of a class stream in bits per object: of the class of an object, and of the class of an object
+// given the class of the previous one, which is what a branch predictor that remembers the last outcome can gain
+struct StreamEntropy {
+    double marginal = 0;
+    double conditional = 0;
+};
+
+StreamEntropy stream_entropy(const std::vector<unsigned>& vals)
+{
+    std::map<unsigned, double> counts;
+    std::map<std::pair<unsigned, unsigned>, double> pairs;
+    for (size_t i = 0; i < vals.size(); i++) {
+        counts[vals[i]]++;
+        if (i > 0) pairs[{ vals[i - 1], vals[i] }]++;
+    }
+    auto entropy = [](const auto& counts, double total) {
+        double h = 0;
+        for (auto&& [key, count]: counts) h -= count / total * std::log2(count / total);
+        return h;
+    };
+    StreamEntropy result;
+    result.marginal = entropy(counts, double(vals.size()));
+    // H(current | previous) = H(previous, current) - H(previous)
+    result.conditional = vals.size() > 1 ? std::max(entropy(pairs, double(vals.size() - 1)) - result.marginal, 0.0) : 0;
+    return result;
+}
 
+// Draws N class numbers in [from, from + width]
+std::vector<unsigned> draw_uniform(unsigned from, unsigned width)
+{
     std::uniform_int_distribution<unsigned> distrib(from, from + width);
 
-    for(uint64_t i = 0; i < N; ++i) {
-        unsigned val = distrib(rng);
+    std::vector<unsigned> vals(N);
+    for (auto& val: vals) val = distrib(rng);
+    return vals;
+}
+
+// Creates the objects of classes `vals` with `make(val)`, allocating them in the order the placement mode asks for
+template<typename Make>
+Objects place_objects(const std::vector<unsigned>& vals, Make&& make)
+{
+    // Objects are allocated in this order
+    std::vector<uint64_t> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    if (placement == Placement::clustered) {
+        std::stable_sort(order.begin(), order.end(), [&vals](uint64_t l, uint64_t r) { return vals[l] < vals[r]; });
+    } else if (placement == Placement::scattered) {
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+
+    Objects v(N);
+    for (uint64_t i: order) v[i] = make(vals[i]);
+    return v;
+}
+
+Objects generate_data(Hierarchy h, const std::vector<unsigned>& vals)
+{
+    return place_objects(vals, [h](unsigned val) -> ObjectPtr {
         if (h == Hierarchy::deep) {
             switch(val) {
-                case  0: v.emplace_back(std::make_unique<A>()); break;
-                case  1: v.emplace_back(std::make_unique<deep::B>()); break;
-                case  2: v.emplace_back(std::make_unique<deep::C>()); break;
-                case  3: v.emplace_back(std::make_unique<deep::D>()); break;
-                case  4: v.emplace_back(std::make_unique<deep::E>()); break;
-                case  5: v.emplace_back(std::make_unique<deep::F>()); break;
-                case  6: v.emplace_back(std::make_unique<deep::G>()); break;
-                case  7: v.emplace_back(std::make_unique<deep::H>()); break;
+                case  0: return make_object<A>();
+                case  1: return make_object<deep::B>();
+                case  2: return make_object<deep::C>();
+                case  3: return make_object<deep::D>();
+                case  4: return make_object<deep::E>();
+                case  5: return make_object<deep::F>();
+                case  6: return make_object<deep::G>();
+                case  7: return make_object<deep::H>();
             }
         } else if (h == Hierarchy::shallow) {
             switch(val) {
-                case  0: v.emplace_back(std::make_unique<A>()); break;
-                case  1: v.emplace_back(std::make_unique<shallow::B>()); break;
-                case  2: v.emplace_back(std::make_unique<shallow::C>()); break;
-                case  3: v.emplace_back(std::make_unique<shallow::D>()); break;
-                case  4: v.emplace_back(std::make_unique<shallow::E>()); break;
-                case  5: v.emplace_back(std::make_unique<shallow::F>()); break;
-                case  6: v.emplace_back(std::make_unique<shallow::G>()); break;
-                case  7: v.emplace_back(std::make_unique<shallow::H>()); break;
+                case  0: return make_object<A>();
+                case  1: return make_object<shallow::B>();
+                case  2: return make_object<shallow::C>();
+                case  3: return make_object<shallow::D>();
+                case  4: return make_object<shallow::E>();
+                case  5: return make_object<shallow::F>();
+                case  6: return make_object<shallow::G>();
+                case  7: return make_object<shallow::H>();
             }
         } else if (h == Hierarchy::balanced) {
             switch(val) {
-                case  0: v.emplace_back(std::make_unique<A>()); break;
-                case  1: v.emplace_back(std::make_unique<balanced::B>()); break;
-                case  2: v.emplace_back(std::make_unique<balanced::C>()); break;
-                case  3: v.emplace_back(std::make_unique<balanced::D>()); break;
-                case  4: v.emplace_back(std::make_unique<balanced::E>()); break;
-                case  5: v.emplace_back(std::make_unique<balanced::F>()); break;
-                case  6: v.emplace_back(std::make_unique<balanced::G>()); break;
-                case  7: v.emplace_back(std::make_unique<balanced::H>()); break;
+                case  0: return make_object<A>();
+                case  1: return make_object<balanced::B>();
+                case  2: return make_object<balanced::C>();
+                case  3: return make_object<balanced::D>();
+                case  4: return make_object<balanced::E>();
+                case  5: return make_object<balanced::F>();
+                case  6: return make_object<balanced::G>();
+                case  7: return make_object<balanced::H>();
             }
         } else if (h == Hierarchy::cross) {
             switch(val) {
-                case  5: v.emplace_back(std::make_unique<cross::F>()); break;
-                case  6: v.emplace_back(std::make_unique<cross::G>()); break;
-                case  7: v.emplace_back(std::make_unique<cross::H>()); break;
+                case  5: return make_object<cross::F>();
+                case  6: return make_object<cross::G>();
+                case  7: return make_object<cross::H>();
             }
         }
+        return nullptr;
+    });
+}
+
+Objects generate_data(Hierarchy h, unsigned from, unsigned width)
+{
+    return generate_data(h, draw_uniform(from, width));
+}
+
+// Objects of random classes of the synthetic hierarchy H
+template<typename H>
+Objects generate_synthetic_data()
+{
+    return place_objects(draw_uniform(0, H::TYPES - 1), [](unsigned val) {
+        return H::make(val, []<typename T>() { return make_object<T>(); });
+    });
+}
+
+// Shared pointers to the objects of `v`, which keeps owning them. Each one gets its own control block, as shared
+// pointers not created with make_shared do.
+using SharedObjects = std::vector<std::shared_ptr<A>>;
+
+SharedObjects make_shared_objects(const Objects& v)
+{
+    SharedObjects shared;
+    shared.reserve(v.size());
+    for (auto&& e: v) shared.emplace_back(e.get(), [](A*) {});
+    return shared;
+}
+
+// Allocator that adds up the bytes it allocates, to measure control blocks
+size_t counted_bytes = 0;
+
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template<typename U> CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) { counted_bytes += n * sizeof(T); return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template<typename U> bool operator==(const CountingAllocator<U>&) const { return true; }
+};
+
+// Bytes make_shared_objects allocates per object for the control block, besides the allocator's own overhead
+size_t control_block_size()
+{
+    counted_bytes = 0;
+    std::shared_ptr<A>(static_cast<A*>(nullptr), [](A*) {}, CountingAllocator<A>());
+    return counted_bytes;
+}
+
+// Bytes of cast metadata of classes: the flattened ancestor tables of vrc and the type tables and base offsets of KCL,
+// of which all but the offsets shrink with narrower type ids
+struct MetadataSize {
+    size_t vrc = 0;
+    size_t kcl = 0;
+};
+
+template<typename... T>
+MetadataSize metadata_size()
+{
+    return { (sizeof(vrc::detail::CastTable<T>::table) + ...),
+             ((sizeof(KCL::RTTI_Private::TypeTable<T>) + sizeof(KCL::RTTI_Private::TypeOffsets<T>::ourOffsets) +
+               sizeof(KCL::RTTI_Private::TypeOffsets<T>::ourAdjusts)) + ...) };
+}
+
+template<typename H>
+MetadataSize synthetic_metadata_size()
+{
+    MetadataSize size;
+    for (unsigned i = 0; i < H::TYPES; i++) {
+        MetadataSize type = H::make(i, []<typename T>() { return metadata_size<T>(); });
+        size.vrc += type.vrc;
+        size.kcl += type.kcl;
     }
-    return v;
+    return size;
+}
+
+void print_metadata_size(const char* name, MetadataSize size)
+{
+    printf("Type metadata of %s: vrc %llu bytes, KCL %llu bytes\n\n", name,
+           static_cast<unsigned long long>(size.vrc), static_cast<unsigned long long>(size.kcl));
+}
+
+// Intrusive references to the objects of `v`. The objects stay owned by `v`: each one also keeps a reference that
+// is never released.
+using RefObjects = std::vector<vrc::Ref<A>>;
+
+RefObjects make_ref_objects(const Objects& v)
+{
+    RefObjects refs;
+    refs.reserve(v.size());
+    for (auto&& e: v) {
+        vrc::Ref<A>(e.get()).detach();
+        refs.emplace_back(e.get());
+    }
+    return refs;
 }
 
-void shuffle(std::vector<std::unique_ptr<A>>& v) {
+void shuffle(Objects& v) {
     std::shuffle(std::begin(v), std::end(v), rng);
 }
 
-void print_average(double num) {
-    double avg = num / 8.0;
+// The data the kernels of run() work on. Thread i of the scaling runs works on data_sets[i] with `--private-data`,
+// on data_sets[0] otherwise, or when there is no copy for it.
+struct DataSet {
+    Objects* objects;
+    vrc::PolyVector<A>* poly;
+    SharedObjects* shared = nullptr;
+    RefObjects* refs = nullptr;
+};
+
+std::vector<DataSet> data_sets;
+
+// With `--threads N`, every row is also run on 1, 2, 4, ... N threads, each pinned to its own CPU where possible
+std::vector<unsigned> thread_counts;
+bool private_data = false;
+
+const unsigned SCALING_PASSES = 3;
+
+template<typename Kernel>
+uint64_t invoke(Kernel& kernel, const DataSet& data)
+{
+    if constexpr (std::is_invocable_v<Kernel&, Objects&>) return kernel(*data.objects);
+    else if constexpr (std::is_invocable_v<Kernel&, SharedObjects&>) return kernel(*data.shared);
+    else if constexpr (std::is_invocable_v<Kernel&, RefObjects&>) return kernel(*data.refs);
+    else return kernel(*data.poly);
+}
+
+void pin_thread(unsigned index)
+{
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % std::max(std::thread::hardware_concurrency(), 1u), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+// Runs the kernel SCALING_PASSES times on every thread at once and returns the aggregate objects per second. The
+// threads time themselves, from the first one starting to the last one finishing.
+template<typename Kernel>
+double run_threads(Kernel& kernel, unsigned threads)
+{
+    using Clock = std::chrono::steady_clock;
+    std::barrier start(threads);
+    std::vector<uint64_t> sums(threads);
+    std::vector<Clock::time_point> begins(threads);
+    std::vector<Clock::time_point> ends(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            pin_thread(t);
+            const DataSet& data = data_sets[private_data && t < data_sets.size() ? t : 0];
+            uint64_t s = 0;
+            start.arrive_and_wait();
+            begins[t] = Clock::now();
+            for (unsigned i = 0; i < SCALING_PASSES; ++i) s += invoke(kernel, data);
+            ends[t] = Clock::now();
+            sums[t] = s;
+        });
+    }
+    for (auto& worker: workers) worker.join();
+    for (uint64_t s: sums) dummy += s;
+    auto elapsed = *std::max_element(ends.begin(), ends.end()) - *std::min_element(begins.begin(), begins.end());
+    return double(threads) * SCALING_PASSES * N / std::chrono::duration<double>(elapsed).count();
+}
+
+// Hardware counters collected over all the samples of a row, when enabled with `--counters`. Counters that can't be
+// opened (no PMU, perf_event_paranoid, other OS) are reported as n/a.
+class PerfCounters {
+public:
+    enum Counter { CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, DTLB_MISSES, COUNT };
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    PerfCounters() = default;
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd: fds) if (fd >= 0) close(fd);
+#endif
+    }
+
+    // Returns false if no counter is available
+    bool open() {
+#if defined(__linux__)
+        const auto cache_miss = [](uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const std::pair<uint32_t, uint64_t> events[COUNT] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D) },
+            { PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL) },
+            { PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB) },
+        };
+        bool any = false;
+        for (int i = 0; i < COUNT; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            any |= fds[i] >= 0;
+        }
+        return any;
+#else
+        return false;
+#endif
+    }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd: fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        for (int fd: fds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (int i = 0; i < COUNT; ++i) {
+            // value, time enabled, time running; scaled up if the counter was multiplexed
+            uint64_t data[3];
+            if (fds[i] < 0 || read(fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                values[i] = -1;
+            } else {
+                values[i] = double(data[0]) * double(data[1]) / double(data[2]);
+            }
+        }
+#endif
+    }
+
+    // Count over the last start/stop, or a negative value if the counter is unavailable
+    double value(Counter counter) const { return values[counter]; }
+
+private:
+    int fds[COUNT] = { -1, -1, -1, -1, -1, -1 };
+    double values[COUNT] = { -1, -1, -1, -1, -1, -1 };
+};
+
+PerfCounters* counters = nullptr;
+
+void print_counters(double casts)
+{
+    static const char* const names[PerfCounters::COUNT] = {
+        "cycles", "instr", "br-miss", "L1d-miss", "LLC-miss", "dTLB-miss"
+    };
+    double cycles = counters->value(PerfCounters::CYCLES);
+    double instructions = counters->value(PerfCounters::INSTRUCTIONS);
+    if (cycles > 0 && instructions >= 0) printf("     IPC %4.2f; per cast:", instructions / cycles);
+    else printf("     IPC  n/a; per cast:");
+    for (int i = 0; i < PerfCounters::COUNT; ++i) {
+        double v = counters->value(PerfCounters::Counter(i));
+        if (v >= 0) printf(" %s %.2f", names[i], v / casts);
+        else printf(" %s n/a", names[i]);
+        printf(i + 1 < PerfCounters::COUNT ? "," : "\n");
+    }
+}
+
+// Every case is repeated until the 95% confidence interval of its mean time is within MAX_REL_ERROR of the mean,
+// or until it has run for MAX_CASE_NSECS
+const size_t MIN_SAMPLES = 5;
+const size_t MAX_SAMPLES = 100;
+const double MAX_REL_ERROR = 0.02;
+const double MAX_CASE_NSECS = 0.25e9;
+
+// Time taken to read the clock around an empty kernel, subtracted from every sample
+double timer_overhead_ns = 0;
+
+// Time per object of the base-line loop over the current data set, which static_casts instead of casting; the net
+// time of a row subtracts it, leaving the cost of the cast itself
+double loop_overhead_ns = 0;
+
+// Nanoseconds per object
+struct Stats {
+    size_t samples;
+    double mean;
+    double median;
+    double min;
+    double p90;
+    double stddev;
+    double net; // median minus loop_overhead_ns
+};
+
+template<typename Kernel>
+double time_once(Kernel& kernel, const DataSet& data, uint64_t& successes)
+{
+    auto t1 = std::chrono::steady_clock::now();
+    successes = invoke(kernel, data);
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t2 - t1).count();
+}
+
+void calibrate_timer()
+{
+    auto empty = [](Objects&) { return uint64_t(0); };
+    Objects none;
+    uint64_t successes = 0;
+    timer_overhead_ns = std::numeric_limits<double>::max();
+    for (int i = 0; i < 1000; ++i) {
+        timer_overhead_ns = std::min(timer_overhead_ns, time_once(empty, DataSet{ &none, nullptr }, successes));
+    }
+}
+
+Stats summarize(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double var = 0;
+    for (double x: samples) var += (x - mean) * (x - mean);
+    Stats stats;
+    stats.samples = n;
+    stats.mean = mean / N;
+    stats.median = (n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2) / N;
+    stats.min = samples.front() / N;
+    stats.p90 = samples[(n * 9 + 9) / 10 - 1] / N;
+    stats.stddev = std::sqrt(var / (n - 1)) / N;
+    stats.net = stats.median - loop_overhead_ns;
+    return stats;
+}
+
+// Where the rows printed by run() belong, for the machine-readable results
+struct Cell {
+    unsigned run = 0;
+    std::string hierarchy;
+    std::string data_set;
+    std::string implementation;
+};
+
+struct Result {
+    Cell cell;
+    std::string target;
+    Stats stats;
+    uint64_t successes;
+    double counters[PerfCounters::COUNT]; // per cast, negative if unavailable
+    std::vector<std::pair<unsigned, double>> scaling; // threads, aggregate objects per second
+};
+
+Cell cell;
+std::vector<Result> results;
+
+// Times the kernel on data_sets[0] until the confidence interval is tight enough, in nanoseconds per pass
+template<typename Kernel>
+std::vector<double> sample(Kernel& kernel, uint64_t& successes)
+{
+    std::vector<double> samples;
+    double sum = 0;
+    double sum_sq = 0;
+    while (samples.size() < MAX_SAMPLES) {
+        double ns = std::max(time_once(kernel, data_sets[0], successes) - timer_overhead_ns, 1.0);
+        samples.push_back(ns);
+        sum += ns;
+        sum_sq += ns * ns;
+        size_t n = samples.size();
+        if (n < MIN_SAMPLES) continue;
+        double mean = sum / n;
+        double stddev = std::sqrt(std::max(sum_sq - sum * mean, 0.0) / (n - 1));
+        if (1.96 * stddev / std::sqrt(double(n)) <= MAX_REL_ERROR * mean || sum >= MAX_CASE_NSECS) break;
+    }
+    return samples;
+}
+
+// Times the no-cast pass over data_sets[0]. run() calls it before the first row of every data set, as every section
+// resets max_num_ops when it switches data sets.
+void calibrate_loop()
+{
+    auto no_cast = [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; };
+    uint64_t successes = 0;
+    loop_overhead_ns = summarize(sample(no_cast, successes)).median;
+}
+
+template<typename Kernel>
+double run(std::string label, Kernel&& kernel)
+{
+    uint64_t successes = 0;
+    if (max_num_ops == 0) calibrate_loop();
+    if (counters) counters->start();
+    std::vector<double> samples = sample(kernel, successes);
+    if (counters) counters->stop();
+    size_t num_samples = samples.size();
+
+    Stats stats = summarize(std::move(samples));
+    double num_ops = 1e9 / stats.median;
+    if (max_num_ops == 0) { max_num_ops = num_ops; } // the base-line run will be 100%
+    double percent = num_ops / max_num_ops;
+    printf(
+            "%3s: %7.2f ns/op (net %7.2f, min %7.2f, p90 %7.2f, sd %6.2f) %6.1f MHz (%3.0f%%) [%7llu] ",
+            label.c_str(),
+            stats.median, stats.net, stats.min, stats.p90, stats.stddev,
+            num_ops / USECS_PER_SEC,
+            percent * 100, static_cast<unsigned long long>(successes)
+          );
+    draw_bar(percent);
+    if (counters) print_counters(double(num_samples) * N);
+
+    Result result{ cell, label, stats, successes, {}, {} };
+    if (!thread_counts.empty()) {
+        printf("     threads:");
+        double single = 0;
+        for (unsigned threads: thread_counts) {
+            double ops = run_threads(kernel, threads);
+            if (threads == 1) single = ops;
+            // Scaling efficiency: aggregate throughput relative to `threads` times the single-threaded one
+            printf(" %u: %.1f MHz (%3.0f%%)", threads, ops / USECS_PER_SEC, ops / (single * threads) * 100);
+            result.scaling.emplace_back(threads, ops);
+        }
+        printf("\n");
+    }
+    for (int i = 0; i < PerfCounters::COUNT; ++i) {
+        double v = counters ? counters->value(PerfCounters::Counter(i)) : -1;
+        result.counters[i] = v >= 0 ? v / (double(num_samples) * N) : -1;
+    }
+    results.push_back(std::move(result));
+    return num_ops;
+}
+
+void print_average(double num, unsigned count = 8) {
+    double avg = num / count;
     printf("------------\n");
-    printf("AVG: %6.1f MHz                  ", avg / USECS_PER_SEC);
+    printf("%-56s%6.1f MHz%18s", "AVG:", avg / USECS_PER_SEC, "");
     draw_bar(avg / max_num_ops, "=");
 }
 
-void run_benchmarks(std::vector<std::unique_ptr<A>>& v, Hierarchy h)
+void print_hierarchy(const char* name) {
+    cell.hierarchy = name;
+    printf("### Class hierarchy: %s\n\n", name);
+}
+
+void print_data_set(const char* name) {
+    cell.data_set = name;
+    printf("#### Cast type: %s\n\n", name);
+}
+
+void print_implementation(const char* name) {
+    cell.implementation = name;
+    printf("Implementation: `%s`\n", name);
+}
+
+const char* const COUNTER_NAMES[PerfCounters::COUNT] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses"
+};
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + '"';
+}
+
+std::string csv_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c: s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + '"';
+}
+
+// One object per line, so that files diff well
+void write_json(std::ostream& out) {
+    out.precision(9);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "{\"run\": " << r.cell.run
+            << ", \"hierarchy\": " << json_string(r.cell.hierarchy)
+            << ", \"data_set\": " << json_string(r.cell.data_set)
+            << ", \"implementation\": " << json_string(r.cell.implementation)
+            << ", \"target\": " << json_string(r.target)
+            << ", \"successes\": " << r.successes
+            << ", \"samples\": " << r.stats.samples
+            << ", \"mean_ns\": " << r.stats.mean
+            << ", \"median_ns\": " << r.stats.median
+            << ", \"min_ns\": " << r.stats.min
+            << ", \"p90_ns\": " << r.stats.p90
+            << ", \"stddev_ns\": " << r.stats.stddev
+            << ", \"net_ns\": " << r.stats.net;
+        for (int c = 0; c < PerfCounters::COUNT; ++c) {
+            if (r.counters[c] >= 0) out << ", \"" << COUNTER_NAMES[c] << "\": " << r.counters[c];
+        }
+        for (auto [threads, ops]: r.scaling) out << ", \"threads_" << threads << "_mhz\": " << ops / USECS_PER_SEC;
+        out << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out << "]\n";
+}
+
+void write_csv(std::ostream& out) {
+    out.precision(9);
+    out << "run,hierarchy,data_set,implementation,target,successes,samples,mean_ns,median_ns,min_ns,p90_ns,stddev_ns,net_ns";
+    for (const char* name: COUNTER_NAMES) out << ',' << name;
+    out << ",scaling_mhz\n";
+    for (const Result& r: results) {
+        out << r.cell.run << ',' << csv_string(r.cell.hierarchy) << ',' << csv_string(r.cell.data_set) << ','
+            << csv_string(r.cell.implementation) << ',' << csv_string(r.target) << ',' << r.successes << ','
+            << r.stats.samples << ',' << r.stats.mean << ',' << r.stats.median << ',' << r.stats.min << ','
+            << r.stats.p90 << ',' << r.stats.stddev << ',' << r.stats.net;
+        for (double v: r.counters) {
+            out << ',';
+            if (v >= 0) out << v;
+        }
+        // threads:MHz pairs
+        out << ",\"";
+        for (size_t i = 0; i < r.scaling.size(); ++i) {
+            out << (i ? ";" : "") << r.scaling[i].first << ':' << r.scaling[i].second / USECS_PER_SEC;
+        }
+        out << "\"\n";
+    }
+}
+
+using Record = std::map<std::string, std::string>;
+
+// Reads the flat objects written by write_json; values are kept as text
+std::vector<Record> read_json(std::istream& in) {
+    std::vector<Record> records;
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    auto skip_space = [&]() { while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos; };
+    auto read_token = [&]() {
+        skip_space();
+        std::string token;
+        if (pos < text.size() && text[pos] == '"') {
+            for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+                if (text[pos] == '\\') ++pos;
+                if (pos < text.size()) token += text[pos];
+            }
+            ++pos;
+        } else {
+            while (pos < text.size() && !std::strchr(",}] \t\r\n", text[pos])) token += text[pos++];
+        }
+        return token;
+    };
+    while ((pos = text.find('{', pos)) != std::string::npos) {
+        Record record;
+        ++pos;
+        for (;;) {
+            skip_space();
+            if (pos >= text.size() || text[pos] == '}') break;
+            std::string key = read_token();
+            skip_space();
+            if (pos < text.size() && text[pos] == ':') ++pos;
+            record[key] = read_token();
+            skip_space();
+            if (pos < text.size() && text[pos] == ',') ++pos;
+        }
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+// Two-sided 95% critical values of Student's t distribution for 1..30 degrees of freedom
+double t_critical(double df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+         2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < 1) return table[0];
+    if (df > 30) return 1.960;
+    return table[size_t(df) - 1];
+}
+
+// Field `name` of a record read by read_json; throws std::runtime_error if the record has no such field
+const std::string& record_field(const Record& r, const char* name) {
+    auto it = r.find(name);
+    if (it == r.end()) throw std::runtime_error(std::string("missing field \"") + name + '"');
+    return it->second;
+}
+
+// Same as record_field, for numeric fields; throws std::runtime_error if the field is not a number
+double number_field(const Record& r, const char* name) {
+    const std::string& text = record_field(r, name);
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0') {
+        throw std::runtime_error(std::string("field \"") + name + "\" is not a number: " + text);
+    }
+    return value;
+}
+
+// Compares two JSON result files cell by cell and lists the cells whose median got slower by more than `threshold`,
+// where Welch's t-test also finds the means different. Returns the number of such regressions, or -1 if a file
+// can't be read or has a record with a missing or malformed field.
+int compare_results(const char* old_path, const char* new_path, double threshold) {
+    std::ifstream old_file(old_path);
+    std::ifstream new_file(new_path);
+    if (!old_file || !new_file) {
+        fprintf(stderr, "Can't open %s\n", old_file ? new_path : old_path);
+        return -1;
+    }
+    auto key = [](const Record& r) {
+        return record_field(r, "run") + '/' + record_field(r, "hierarchy") + '/' + record_field(r, "data_set") + '/'
+            + record_field(r, "implementation") + '/' + record_field(r, "target");
+    };
+    std::map<std::string, Record> old_results;
+
+    int compared = 0;
+    int slower = 0;
+    int faster = 0;
+    // The record being read, for the error message
+    const char* path = old_path;
+    size_t row = 0;
+    try {
+        for (auto& r: read_json(old_file)) {
+            ++row;
+            old_results[key(r)] = std::move(r);
+        }
+        path = new_path;
+        row = 0;
+        for (const auto& r: read_json(new_file)) {
+            ++row;
+            // Run 0 only warms up
+            if (record_field(r, "run") == "0") continue;
+            auto it = old_results.find(key(r));
+            if (it == old_results.end()) continue;
+            const auto& o = it->second;
+            double n1 = number_field(o, "samples"), n2 = number_field(r, "samples");
+            double m1 = number_field(o, "mean_ns"), m2 = number_field(r, "mean_ns");
+            double v1 = std::pow(number_field(o, "stddev_ns"), 2) / n1;
+            double v2 = std::pow(number_field(r, "stddev_ns"), 2) / n2;
+            double t = (m2 - m1) / std::sqrt(std::max(v1 + v2, 1e-30));
+            double df = (v1 + v2) * (v1 + v2) / std::max(v1 * v1 / (n1 - 1) + v2 * v2 / (n2 - 1), 1e-30);
+            double old_median = number_field(o, "median_ns"), new_median = number_field(r, "median_ns");
+            double change = new_median / old_median - 1;
+            bool significant = std::abs(t) > t_critical(df);
+            ++compared;
+            if (significant && change > threshold) {
+                ++slower;
+                printf("SLOWER  %s: %.2f -> %.2f ns/op (%+.1f%%, t = %.1f)\n",
+                       key(r).c_str(), old_median, new_median, change * 100, t);
+            } else if (significant && change < -threshold) {
+                ++faster;
+                printf("FASTER  %s: %.2f -> %.2f ns/op (%+.1f%%, t = %.1f)\n",
+                       key(r).c_str(), old_median, new_median, change * 100, t);
+            }
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s: record %zu: %s\n", path, row, e.what());
+        return -1;
+    }
+    printf("%d cells compared, %d slower, %d faster (threshold %.1f%%)\n", compared, slower, faster, threshold * 100);
+    return slower;
+}
+
+// Calls `copy` with every object of `v`, as a reference to its concrete class
+template<typename... Ts, typename Copy>
+void copy_each(const Objects& v, Copy&& copy)
+{
+    for (auto&& e: v) {
+        ((typeid(*e) == typeid(Ts) && (copy(static_cast<const Ts&>(*e)), true)) || ...);
+    }
+}
+
+template<typename Copy>
+void copy_each(const Objects& v, Hierarchy h, Copy&& copy)
+{
+    switch (h) {
+        case Hierarchy::deep:     return copy_each<A, deep::B, deep::C, deep::D, deep::E, deep::F, deep::G, deep::H>(v, copy);
+        case Hierarchy::shallow:  return copy_each<A, shallow::B, shallow::C, shallow::D, shallow::E, shallow::F, shallow::G, shallow::H>(v, copy);
+        case Hierarchy::balanced: return copy_each<A, balanced::B, balanced::C, balanced::D, balanced::E, balanced::F, balanced::G, balanced::H>(v, copy);
+        case Hierarchy::cross:    return copy_each<cross::F, cross::G, cross::H>(v, copy);
+    }
+}
+
+// Copies the objects of `v` into a container partitioned by concrete class
+vrc::PolyVector<A> make_poly_vector(const Objects& v, Hierarchy h)
+{
+    vrc::PolyVector<A> pv;
+    copy_each(v, h, [&pv](const auto& e) { pv.emplaceBack<std::decay_t<decltype(e)>>(e); });
+    return pv;
+}
+
+// Copies the objects of `v`, allocated in the order they appear in `v`
+Objects copy_objects(const Objects& v, Hierarchy h)
+{
+    Objects copy;
+    copy.reserve(v.size());
+    copy_each(v, h, [&copy](const auto& e) { copy.push_back(make_object<std::decay_t<decltype(e)>>(e)); });
+    return copy;
+}
+
+// Batched casts resolve chunks of the input at once and then sum the field over the objects that cast
+constexpr size_t BATCH = 1024;
+
+template<typename T>
+uint64_t vrc_batch_sum(const Objects& v, uint64_t T::*field)
+{
+    uint64_t s = 0;
+    T* out[BATCH];
+    for (size_t i = 0; i < v.size(); i += BATCH) {
+        std::span<const ObjectPtr> chunk(v.data() + i, std::min(BATCH, v.size() - i));
+        size_t n = vrc::dynamicCastBatch<T>(chunk, out);
+        for (size_t j = 0; j < n; ++j) s += out[j]->*field;
+    }
+    return s;
+}
+
+template<typename T>
+uint64_t kcl_batch_sum(const Objects& v, uint64_t T::*field)
+{
+    uint64_t s = 0;
+    T* out[BATCH];
+    for (size_t i = 0; i < v.size(); i += BATCH) {
+        auto first = v.begin() + i;
+        size_t n = kcl_dynamic_cast_batch<T*>(first, first + std::min(BATCH, v.size() - i), out);
+        for (size_t j = 0; j < n; ++j) s += out[j]->*field;
+    }
+    return s;
+}
+
+// Sums `Field` over the objects that `cast` turns into a T*
+template<typename T, auto Field, typename Cast>
+uint64_t cast_sum(const Objects& v, Cast cast)
+{
+    uint64_t s = 0;
+    for (auto&& e: v) { auto *p = cast.template operator()<T>(e.get()); s += p ? p->*Field : e->z; }
+    return s;
+}
+
+// Counts the objects that `cast` turns into a T*, without touching the result
+template<typename T, typename Cast>
+uint64_t cast_count(const Objects& v, Cast cast)
+{
+    uint64_t s = 0;
+    for (auto&& e: v) s += cast.template operator()<T>(e.get()) != nullptr;
+    return s;
+}
+
+// Same as cast_sum, over shared or intrusive pointers; `cast` may return a smart or a raw pointer
+template<typename T, auto Field, typename Pointers, typename Cast>
+uint64_t pointer_cast_sum(const Pointers& v, Cast cast)
+{
+    uint64_t s = 0;
+    for (auto&& e: v) { auto p = cast.template operator()<T>(e); s += p ? std::to_address(p)->*Field : e->z; }
+    return s;
+}
+
+// Class a handler of run_type_switch takes
+template<typename Ret, typename Class, typename Arg>
+Arg* handler_arg(Ret (Class::*)(Arg&) const);
+
+template<typename Func>
+using handler_class = std::remove_pointer_t<decltype(handler_arg(&Func::operator()))>;
+
+// Sums what the first of `funcs` whose class `cast` succeeds for returns, over the objects
+template<typename Cast, typename... Funcs>
+uint64_t cascade_sum(const Objects& v, Cast cast, Funcs... funcs)
+{
+    uint64_t s = 0;
+    for (auto&& e: v) {
+        ([&] { auto *p = cast.template operator()<handler_class<Funcs>>(e.get()); if (p) s += funcs(*p); return p != nullptr; }() || ...);
+    }
+    return s;
+}
+
+// Rows std and vrc try the classes of `funcs` in turn with dynamic_cast and vrc::dynamicCast, row sw dispatches
+// with a single vrc::typeSwitch
+template<typename... Funcs>
+void run_type_switch(Funcs... funcs)
+{
+    run("std", [=](Objects& v) { return cascade_sum(v, []<typename T>(A* p) { return dynamic_cast<T*>(p); }, funcs...); });
+    run("vrc", [=](Objects& v) { return cascade_sum(v, []<typename T>(A* p) { return vrc::dynamicCast<T>(p); }, funcs...); });
+    run("sw",  [=](Objects& v) { uint64_t s = 0; for (auto&& e: v) s += vrc::typeSwitch(e.get(), funcs...); return s; });
+}
+
+void run_benchmarks(Objects& v, Hierarchy h)
 {
     double sum = 0;
 
     max_num_ops = 0;
 
+    auto pv = make_poly_vector(v, h);
+    auto shared = make_shared_objects(v);
+    auto refs = make_ref_objects(v);
+    data_sets = { DataSet{ &v, &pv, &shared, &refs } };
+
+    // Copies for the other threads of the scaling runs
+    std::vector<Objects> copies;
+    std::vector<vrc::PolyVector<A>> poly_copies;
+    std::vector<SharedObjects> shared_copies;
+    std::vector<RefObjects> ref_copies;
+    if (private_data && !thread_counts.empty()) {
+        unsigned threads = thread_counts.back();
+        copies.reserve(threads - 1);
+        poly_copies.reserve(threads - 1);
+        shared_copies.reserve(threads - 1);
+        ref_copies.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t) {
+            copies.push_back(copy_objects(v, h));
+            poly_copies.push_back(make_poly_vector(v, h));
+            shared_copies.push_back(make_shared_objects(copies.back()));
+            ref_copies.push_back(make_ref_objects(copies.back()));
+            data_sets.push_back(DataSet{ &copies.back(), &poly_copies.back(), &shared_copies.back(), &ref_copies.back() });
+        }
+    }
+
     // Cache warming
     dummy += [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; }();
 
+    cell.implementation = "static_cast";
     printf("Base-line: static_cast\n");
     printf("```\n");
-             run("-", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+             run("-", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; });
     printf("```\n\n");
 
     if (h == Hierarchy::deep) {
-        printf("Implementation: `dynamic_cast`\n");
+        print_implementation("dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<      Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n");
+
+        print_implementation("cached_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<deep::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<      Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::cachedDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::flatDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::intervalCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::bitsetCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<      A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<deep::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<      Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCastBatch");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { return vrc_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return vrc_batch_sum<deep::B>(v, &deep::B::b); });
+        sum   += run("C", [](Objects& v) { return vrc_batch_sum<deep::C>(v, &deep::C::c); });
+        sum   += run("D", [](Objects& v) { return vrc_batch_sum<deep::D>(v, &deep::D::d); });
+        sum   += run("E", [](Objects& v) { return vrc_batch_sum<deep::E>(v, &deep::E::e); });
+        sum   += run("F", [](Objects& v) { return vrc_batch_sum<deep::F>(v, &deep::F::f); });
+        sum   += run("G", [](Objects& v) { return vrc_batch_sum<deep::G>(v, &deep::G::g); });
+        sum   += run("H", [](Objects& v) { return vrc_batch_sum<deep::H>(v, &deep::H::h); });
+        sum   += run("Z", [](Objects& v) { return vrc_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast");
         printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<      Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
 
-        printf("Implementation: `vrc::dynamicCast`\n");
+        print_implementation("kcl_dynamic_cast_batch");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<      A>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::B>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::C>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::D>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::E>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::F>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::G>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<deep::H>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<      Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { return kcl_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return kcl_batch_sum<deep::B>(v, &deep::B::b); });
+        sum   += run("C", [](Objects& v) { return kcl_batch_sum<deep::C>(v, &deep::C::c); });
+        sum   += run("D", [](Objects& v) { return kcl_batch_sum<deep::D>(v, &deep::D::d); });
+        sum   += run("E", [](Objects& v) { return kcl_batch_sum<deep::E>(v, &deep::E::e); });
+        sum   += run("F", [](Objects& v) { return kcl_batch_sum<deep::F>(v, &deep::F::f); });
+        sum   += run("G", [](Objects& v) { return kcl_batch_sum<deep::G>(v, &deep::G::g); });
+        sum   += run("H", [](Objects& v) { return kcl_batch_sum<deep::H>(v, &deep::H::h); });
+        sum   += run("Z", [](Objects& v) { return kcl_batch_sum<Z>(v, &Z::z); });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `kcl_dynamic_cast`\n");
+        print_implementation("vrc::PolyVector");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<      A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<deep::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<      Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<A>([&s](A& p) { s += p.a; }); return s; });
+        sum   += run("B", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::B>([&s](deep::B& p) { s += p.b; }); return s; });
+        sum   += run("C", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::C>([&s](deep::C& p) { s += p.c; }); return s; });
+        sum   += run("D", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::D>([&s](deep::D& p) { s += p.d; }); return s; });
+        sum   += run("E", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::E>([&s](deep::E& p) { s += p.e; }); return s; });
+        sum   += run("F", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::F>([&s](deep::F& p) { s += p.f; }); return s; });
+        sum   += run("G", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::G>([&s](deep::G& p) { s += p.g; }); return s; });
+        sum   += run("H", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<deep::H>([&s](deep::H& p) { s += p.h; }); return s; });
+        sum   += run("Z", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<Z>([&s](Z& p) { s += p.z; }); return s; });
         print_average(sum);
         printf("```\n\n");
 
     } else if (h == Hierarchy::shallow) {
-        printf("Implementation: `dynamic_cast`\n");
+        print_implementation("dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<         A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<         Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("cached_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<         A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<shallow::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<         Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::cachedDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::flatDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::intervalCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::bitsetCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCastBatch");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { return vrc_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return vrc_batch_sum<shallow::B>(v, &shallow::B::b); });
+        sum   += run("C", [](Objects& v) { return vrc_batch_sum<shallow::C>(v, &shallow::C::c); });
+        sum   += run("D", [](Objects& v) { return vrc_batch_sum<shallow::D>(v, &shallow::D::d); });
+        sum   += run("E", [](Objects& v) { return vrc_batch_sum<shallow::E>(v, &shallow::E::e); });
+        sum   += run("F", [](Objects& v) { return vrc_batch_sum<shallow::F>(v, &shallow::F::f); });
+        sum   += run("G", [](Objects& v) { return vrc_batch_sum<shallow::G>(v, &shallow::G::g); });
+        sum   += run("H", [](Objects& v) { return vrc_batch_sum<shallow::H>(v, &shallow::H::h); });
+        sum   += run("Z", [](Objects& v) { return vrc_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<         A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<shallow::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<         Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<         A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<         Z*>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `vrc::dynamicCast`\n");
+        print_implementation("kcl_dynamic_cast_batch");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<         A>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::B>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::C>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::D>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::E>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::F>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::G>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<shallow::H>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<         Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { return kcl_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return kcl_batch_sum<shallow::B>(v, &shallow::B::b); });
+        sum   += run("C", [](Objects& v) { return kcl_batch_sum<shallow::C>(v, &shallow::C::c); });
+        sum   += run("D", [](Objects& v) { return kcl_batch_sum<shallow::D>(v, &shallow::D::d); });
+        sum   += run("E", [](Objects& v) { return kcl_batch_sum<shallow::E>(v, &shallow::E::e); });
+        sum   += run("F", [](Objects& v) { return kcl_batch_sum<shallow::F>(v, &shallow::F::f); });
+        sum   += run("G", [](Objects& v) { return kcl_batch_sum<shallow::G>(v, &shallow::G::g); });
+        sum   += run("H", [](Objects& v) { return kcl_batch_sum<shallow::H>(v, &shallow::H::h); });
+        sum   += run("Z", [](Objects& v) { return kcl_batch_sum<Z>(v, &Z::z); });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `kcl_dynamic_cast`\n");
+        print_implementation("vrc::PolyVector");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<         A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<shallow::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<         Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<A>([&s](A& p) { s += p.a; }); return s; });
+        sum   += run("B", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::B>([&s](shallow::B& p) { s += p.b; }); return s; });
+        sum   += run("C", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::C>([&s](shallow::C& p) { s += p.c; }); return s; });
+        sum   += run("D", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::D>([&s](shallow::D& p) { s += p.d; }); return s; });
+        sum   += run("E", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::E>([&s](shallow::E& p) { s += p.e; }); return s; });
+        sum   += run("F", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::F>([&s](shallow::F& p) { s += p.f; }); return s; });
+        sum   += run("G", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::G>([&s](shallow::G& p) { s += p.g; }); return s; });
+        sum   += run("H", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<shallow::H>([&s](shallow::H& p) { s += p.h; }); return s; });
+        sum   += run("Z", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<Z>([&s](Z& p) { s += p.z; }); return s; });
         print_average(sum);
         printf("```\n\n");
 
     } else if (h == Hierarchy::balanced) {
-        printf("Implementation: `dynamic_cast`\n");
+        print_implementation("dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<          A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<          Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("cached_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<          A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<balanced::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<          Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::cachedDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::flatDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::intervalCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<          A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<balanced::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<          Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `vrc::dynamicCast`\n");
+        print_implementation("vrc::bitsetCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<          A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<balanced::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<          Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `kcl_dynamic_cast`\n");
+        print_implementation("vrc::dynamicCastBatch");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<          A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<          Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { return vrc_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return vrc_batch_sum<balanced::B>(v, &balanced::B::b); });
+        sum   += run("C", [](Objects& v) { return vrc_batch_sum<balanced::C>(v, &balanced::C::c); });
+        sum   += run("D", [](Objects& v) { return vrc_batch_sum<balanced::D>(v, &balanced::D::d); });
+        sum   += run("E", [](Objects& v) { return vrc_batch_sum<balanced::E>(v, &balanced::E::e); });
+        sum   += run("F", [](Objects& v) { return vrc_batch_sum<balanced::F>(v, &balanced::F::f); });
+        sum   += run("G", [](Objects& v) { return vrc_batch_sum<balanced::G>(v, &balanced::G::g); });
+        sum   += run("H", [](Objects& v) { return vrc_batch_sum<balanced::H>(v, &balanced::H::h); });
+        sum   += run("Z", [](Objects& v) { return vrc_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<          A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<balanced::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<          Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast_batch");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { return kcl_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return kcl_batch_sum<balanced::B>(v, &balanced::B::b); });
+        sum   += run("C", [](Objects& v) { return kcl_batch_sum<balanced::C>(v, &balanced::C::c); });
+        sum   += run("D", [](Objects& v) { return kcl_batch_sum<balanced::D>(v, &balanced::D::d); });
+        sum   += run("E", [](Objects& v) { return kcl_batch_sum<balanced::E>(v, &balanced::E::e); });
+        sum   += run("F", [](Objects& v) { return kcl_batch_sum<balanced::F>(v, &balanced::F::f); });
+        sum   += run("G", [](Objects& v) { return kcl_batch_sum<balanced::G>(v, &balanced::G::g); });
+        sum   += run("H", [](Objects& v) { return kcl_batch_sum<balanced::H>(v, &balanced::H::h); });
+        sum   += run("Z", [](Objects& v) { return kcl_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::PolyVector");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<A>([&s](A& p) { s += p.a; }); return s; });
+        sum   += run("B", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::B>([&s](balanced::B& p) { s += p.b; }); return s; });
+        sum   += run("C", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::C>([&s](balanced::C& p) { s += p.c; }); return s; });
+        sum   += run("D", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::D>([&s](balanced::D& p) { s += p.d; }); return s; });
+        sum   += run("E", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::E>([&s](balanced::E& p) { s += p.e; }); return s; });
+        sum   += run("F", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::F>([&s](balanced::F& p) { s += p.f; }); return s; });
+        sum   += run("G", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::G>([&s](balanced::G& p) { s += p.g; }); return s; });
+        sum   += run("H", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<balanced::H>([&s](balanced::H& p) { s += p.h; }); return s; });
+        sum   += run("Z", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<Z>([&s](Z& p) { s += p.z; }); return s; });
         print_average(sum);
         printf("```\n\n");
 
     } else if (h == Hierarchy::cross) {
-        printf("Implementation: `dynamic_cast`\n");
+        print_implementation("dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<       A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<       Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("cached_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<       A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<cross::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = cached_dynamic_cast<       Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::dynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::cachedDynamicCast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::cachedDynamicCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::flatDynamicCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<       A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<cross::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = dynamic_cast<       Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::flatDynamicCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `vrc::dynamicCast`\n");
+        print_implementation("vrc::intervalCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::dynamicCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::intervalCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
-        printf("Implementation: `kcl_dynamic_cast`\n");
+        print_implementation("vrc::bitsetCast");
         printf("```\n");
         sum = 0;
-        dummy += run("A", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<       A*>(e.get()); s += p ? p->a : e->z; } return s; });
-        sum   += run("B", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::B*>(e.get()); s += p ? p->b : e->z; } return s; });
-        sum   += run("C", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::C*>(e.get()); s += p ? p->c : e->z; } return s; });
-        sum   += run("D", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::D*>(e.get()); s += p ? p->d : e->z; } return s; });
-        sum   += run("E", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::E*>(e.get()); s += p ? p->e : e->z; } return s; });
-        sum   += run("F", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::F*>(e.get()); s += p ? p->f : e->z; } return s; });
-        sum   += run("G", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::G*>(e.get()); s += p ? p->g : e->z; } return s; });
-        sum   += run("H", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::H*>(e.get()); s += p ? p->h : e->z; } return s; });
-        sum   += run("Z", [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<       Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<       A>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::B>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::C>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::D>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::E>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::F>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::G>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<cross::H>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = vrc::bitsetCast<       Z>(e.get()); s += p ? p->z : e->z; } return s; });
         print_average(sum);
         printf("```\n\n");
 
+        print_implementation("vrc::dynamicCastBatch");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { return vrc_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return vrc_batch_sum<cross::B>(v, &cross::B::b); });
+        sum   += run("C", [](Objects& v) { return vrc_batch_sum<cross::C>(v, &cross::C::c); });
+        sum   += run("D", [](Objects& v) { return vrc_batch_sum<cross::D>(v, &cross::D::d); });
+        sum   += run("E", [](Objects& v) { return vrc_batch_sum<cross::E>(v, &cross::E::e); });
+        sum   += run("F", [](Objects& v) { return vrc_batch_sum<cross::F>(v, &cross::F::f); });
+        sum   += run("G", [](Objects& v) { return vrc_batch_sum<cross::G>(v, &cross::G::g); });
+        sum   += run("H", [](Objects& v) { return vrc_batch_sum<cross::H>(v, &cross::H::h); });
+        sum   += run("Z", [](Objects& v) { return vrc_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<       A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        sum   += run("B", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::B*>(e.get()); s += p ? p->b : e->z; } return s; });
+        sum   += run("C", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::C*>(e.get()); s += p ? p->c : e->z; } return s; });
+        sum   += run("D", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::D*>(e.get()); s += p ? p->d : e->z; } return s; });
+        sum   += run("E", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::E*>(e.get()); s += p ? p->e : e->z; } return s; });
+        sum   += run("F", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::F*>(e.get()); s += p ? p->f : e->z; } return s; });
+        sum   += run("G", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::G*>(e.get()); s += p ? p->g : e->z; } return s; });
+        sum   += run("H", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<cross::H*>(e.get()); s += p ? p->h : e->z; } return s; });
+        sum   += run("Z", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = kcl_dynamic_cast<       Z*>(e.get()); s += p ? p->z : e->z; } return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("kcl_dynamic_cast_batch");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](Objects& v) { return kcl_batch_sum<A>(v, &A::a); });
+        sum   += run("B", [](Objects& v) { return kcl_batch_sum<cross::B>(v, &cross::B::b); });
+        sum   += run("C", [](Objects& v) { return kcl_batch_sum<cross::C>(v, &cross::C::c); });
+        sum   += run("D", [](Objects& v) { return kcl_batch_sum<cross::D>(v, &cross::D::d); });
+        sum   += run("E", [](Objects& v) { return kcl_batch_sum<cross::E>(v, &cross::E::e); });
+        sum   += run("F", [](Objects& v) { return kcl_batch_sum<cross::F>(v, &cross::F::f); });
+        sum   += run("G", [](Objects& v) { return kcl_batch_sum<cross::G>(v, &cross::G::g); });
+        sum   += run("H", [](Objects& v) { return kcl_batch_sum<cross::H>(v, &cross::H::h); });
+        sum   += run("Z", [](Objects& v) { return kcl_batch_sum<Z>(v, &Z::z); });
+        print_average(sum);
+        printf("```\n\n");
+
+        print_implementation("vrc::PolyVector");
+        printf("```\n");
+        sum = 0;
+        dummy += run("A", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<A>([&s](A& p) { s += p.a; }); return s; });
+        sum   += run("B", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::B>([&s](cross::B& p) { s += p.b; }); return s; });
+        sum   += run("C", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::C>([&s](cross::C& p) { s += p.c; }); return s; });
+        sum   += run("D", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::D>([&s](cross::D& p) { s += p.d; }); return s; });
+        sum   += run("E", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::E>([&s](cross::E& p) { s += p.e; }); return s; });
+        sum   += run("F", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::F>([&s](cross::F& p) { s += p.f; }); return s; });
+        sum   += run("G", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::G>([&s](cross::G& p) { s += p.g; }); return s; });
+        sum   += run("H", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<cross::H>([&s](cross::H& p) { s += p.h; }); return s; });
+        sum   += run("Z", [](vrc::PolyVector<A>& pv) { uint64_t s = 0; pv.forEach<Z>([&s](Z& p) { s += p.z; }); return s; });
+        print_average(sum);
+        printf("```\n\n");
+
+    }
+
+    // Exact-type casts to the leaf classes, which have no derived classes to search
+    auto run_leaves = [&](const char* name, auto cast) {
+        print_implementation(name);
+        printf("```\n");
+        sum = 0;
+        unsigned count = 0;
+        auto row = [&]<typename T, auto Field>(const char* label) {
+            sum += run(label, [cast](Objects& v) { return cast_sum<T, Field>(v, cast); });
+            ++count;
+        };
+        switch (h) {
+            case Hierarchy::deep:
+                row.template operator()<deep::H, &deep::H::h>("H");
+                break;
+            case Hierarchy::shallow:
+                row.template operator()<shallow::B, &shallow::B::b>("B");
+                row.template operator()<shallow::C, &shallow::C::c>("C");
+                row.template operator()<shallow::D, &shallow::D::d>("D");
+                row.template operator()<shallow::E, &shallow::E::e>("E");
+                row.template operator()<shallow::F, &shallow::F::f>("F");
+                row.template operator()<shallow::G, &shallow::G::g>("G");
+                row.template operator()<shallow::H, &shallow::H::h>("H");
+                break;
+            case Hierarchy::balanced:
+                row.template operator()<balanced::C, &balanced::C::c>("C");
+                row.template operator()<balanced::D, &balanced::D::d>("D");
+                row.template operator()<balanced::F, &balanced::F::f>("F");
+                row.template operator()<balanced::G, &balanced::G::g>("G");
+                row.template operator()<balanced::H, &balanced::H::h>("H");
+                break;
+            case Hierarchy::cross:
+                row.template operator()<cross::H, &cross::H::h>("H");
+                break;
+        }
+        row.template operator()<Z, &Z::z>("Z");
+        print_average(sum, count);
+        printf("```\n\n");
+    };
+    run_leaves("vrc::exactCast", []<typename T>(A* p) { return vrc::exactCast<T>(p); });
+    run_leaves("kcl_exact_cast", []<typename T>(A* p) { return kcl_exact_cast<T*>(p); });
+
+    // One field per object, from the most derived class it is a kind of
+    print_implementation("vrc::typeSwitch");
+    printf("```\n");
+    switch (h) {
+        case Hierarchy::deep:
+            run_type_switch([](deep::H& p) { return p.h; }, [](deep::G& p) { return p.g; }, [](deep::F& p) { return p.f; },
+                            [](deep::E& p) { return p.e; }, [](deep::D& p) { return p.d; }, [](deep::C& p) { return p.c; },
+                            [](deep::B& p) { return p.b; }, [](A& p) { return p.a; });
+            break;
+        case Hierarchy::shallow:
+            run_type_switch([](shallow::B& p) { return p.b; }, [](shallow::C& p) { return p.c; }, [](shallow::D& p) { return p.d; },
+                            [](shallow::E& p) { return p.e; }, [](shallow::F& p) { return p.f; }, [](shallow::G& p) { return p.g; },
+                            [](shallow::H& p) { return p.h; }, [](A& p) { return p.a; });
+            break;
+        case Hierarchy::balanced:
+            run_type_switch([](balanced::C& p) { return p.c; }, [](balanced::D& p) { return p.d; }, [](balanced::B& p) { return p.b; },
+                            [](balanced::F& p) { return p.f; }, [](balanced::G& p) { return p.g; }, [](balanced::H& p) { return p.h; },
+                            [](balanced::E& p) { return p.e; }, [](A& p) { return p.a; });
+            break;
+        case Hierarchy::cross:
+            run_type_switch([](cross::H& p) { return p.h; }, [](cross::G& p) { return p.g; }, [](cross::F& p) { return p.f; });
+            break;
+    }
+    printf("```\n\n");
+
+    // Casts of shared and intrusive pointers: through get() (the type lookup alone), by copy (the result shares the
+    // count, one atomic increment and decrement per successful cast), and by move (of a copy, as a function taking
+    // the pointer by value would do). Without `--private-data`, the threads of the scaling runs contend for the same
+    // counts.
+    auto run_pointers = [&]<typename Pointers>(std::type_identity<Pointers>, const char* name, auto cast) {
+        print_implementation(name);
+        printf("```\n");
+        sum = 0;
+        auto row = [&]<typename T, auto Field>(const char* label) {
+            sum += run(label, [cast](Pointers& v) { return pointer_cast_sum<T, Field>(v, cast); });
+        };
+        switch (h) {
+            case Hierarchy::deep:
+                row.template operator()<deep::B, &deep::B::b>("B");
+                row.template operator()<deep::H, &deep::H::h>("H");
+                break;
+            case Hierarchy::shallow:
+                row.template operator()<shallow::B, &shallow::B::b>("B");
+                row.template operator()<shallow::H, &shallow::H::h>("H");
+                break;
+            case Hierarchy::balanced:
+                row.template operator()<balanced::B, &balanced::B::b>("B");
+                row.template operator()<balanced::H, &balanced::H::h>("H");
+                break;
+            case Hierarchy::cross:
+                row.template operator()<cross::B, &cross::B::b>("B");
+                row.template operator()<cross::H, &cross::H::h>("H");
+                break;
+        }
+        row.template operator()<Z, &Z::z>("Z");
+        print_average(sum, 3);
+        printf("```\n\n");
+    };
+    using SharedA = std::shared_ptr<A>;
+    using RefA = vrc::Ref<A>;
+    constexpr std::type_identity<SharedObjects> shared_ptrs;
+    constexpr std::type_identity<RefObjects> ref_ptrs;
+    run_pointers(shared_ptrs, "dynamic_cast(get())",             []<typename T>(const SharedA& p) { return dynamic_cast<T*>(p.get()); });
+    run_pointers(shared_ptrs, "std::dynamic_pointer_cast",       []<typename T>(const SharedA& p) { return std::dynamic_pointer_cast<T>(p); });
+    run_pointers(shared_ptrs, "std::dynamic_pointer_cast(move)", []<typename T>(const SharedA& p) { return std::dynamic_pointer_cast<T>(SharedA(p)); });
+    run_pointers(shared_ptrs, "vrc::dynamicCast(get())",         []<typename T>(const SharedA& p) { return vrc::dynamicCast<T>(p.get()); });
+    run_pointers(shared_ptrs, "vrc::dynamicCast(shared_ptr)",    []<typename T>(const SharedA& p) { return vrc::dynamicCast<T>(p); });
+    run_pointers(shared_ptrs, "vrc::dynamicCast(move)",          []<typename T>(const SharedA& p) { return vrc::dynamicCast<T>(SharedA(p)); });
+    run_pointers(ref_ptrs,    "vrc::dynamicCast(Ref)",           []<typename T>(const RefA& p) { return vrc::dynamicCast<T>(p); });
+    run_pointers(ref_ptrs,    "vrc::dynamicCast(Ref, move)",     []<typename T>(const RefA& p) { return vrc::dynamicCast<T>(RefA(p)); });
+}
+
+// One row per target of H, and Z, for the implementation given by `cast`
+template<typename H, typename Cast>
+void run_synthetic_implementation(const char* name, Cast cast)
+{
+    double sum = 0;
+    unsigned count = 0;
+    auto row = [&]<typename T, auto Field>(const char* label) {
+        sum += run(label, [cast](Objects& v) { return cast_sum<T, Field>(v, cast); });
+        ++count;
+    };
+
+    print_implementation(name);
+    printf("```\n");
+    H::for_each_target(row);
+    row.template operator()<Z, &Z::z>("Z");
+    print_average(sum, count);
+    printf("```\n\n");
+}
+
+void run_synthetic_benchmarks(Objects& v, auto hierarchy)
+{
+    using H = decltype(hierarchy);
+
+    max_num_ops = 0;
+    data_sets = { DataSet{ &v, nullptr } };
+
+    print_hierarchy(H::NAME);
+    printf("%u classes below A, %u levels deep, at most %u derived classes per class, %u%% with a second base\n",
+           H::TYPES, H::DEPTH, H::FANOUT, H::MI_PERCENT);
+    printf("Targets dN are the classes N levels below A along the deepest path, I0 an interface.\n\n");
+    print_data_set("Mixed (cast from random classes)");
+
+    // Cache warming
+    dummy += [&v]() { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; }();
+
+    cell.implementation = "static_cast";
+    printf("Base-line: static_cast\n");
+    printf("```\n");
+             run("-", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+    printf("```\n\n");
+
+    run_synthetic_implementation<H>("dynamic_cast",           []<typename T>(A* p) { return dynamic_cast<T*>(p); });
+    run_synthetic_implementation<H>("cached_dynamic_cast",    []<typename T>(A* p) { return cached_dynamic_cast<T*>(p); });
+    run_synthetic_implementation<H>("vrc::dynamicCast",       []<typename T>(A* p) { return vrc::dynamicCast<T>(p); });
+    run_synthetic_implementation<H>("vrc::cachedDynamicCast", []<typename T>(A* p) { return vrc::cachedDynamicCast<T>(p); });
+    run_synthetic_implementation<H>("vrc::flatDynamicCast",   []<typename T>(A* p) { return vrc::flatDynamicCast<T>(p); });
+    run_synthetic_implementation<H>("vrc::intervalCast",      []<typename T>(A* p) { return vrc::intervalCast<T>(p); });
+    run_synthetic_implementation<H>("vrc::bitsetCast",        []<typename T>(A* p) { return vrc::bitsetCast<T>(p); });
+    run_synthetic_implementation<H>("kcl_dynamic_cast",       []<typename T>(A* p) { return kcl_dynamic_cast<T*>(p); });
+}
+
+// Data sets of the deep hierarchy for run_workload_benchmarks, which casts them to E: objects of classes E to H
+// succeed
+struct WorkloadData {
+    Workload workload;
+    Objects objects;
+    StreamEntropy entropy;
+    double success = 0;
+};
+
+std::vector<WorkloadData> generate_workloads()
+{
+    auto succeeds = [](unsigned val) { return val >= 4; };
+    std::vector<Workload> workloads = {
+        { "uniform", zipf_weights(0, 7, 0) },
+        { "Zipf 1", zipf_weights(0, 7, 1) },
+        { "Zipf 2", zipf_weights(0, 7, 2) },
+        { "uniform, 90% successful", zipf_weights(0, 7, 0), 0.9, succeeds },
+        { "uniform, 10% successful", zipf_weights(0, 7, 0), 0.1, succeeds },
+        { "uniform, runs of 8", zipf_weights(0, 7, 0), -1, nullptr, 8 },
+        { "uniform, runs of 64", zipf_weights(0, 7, 0), -1, nullptr, 64 },
+        { "class G only", zipf_weights(6, 0, 0) },
+    };
+    std::vector<WorkloadData> data;
+    for (auto& workload: workloads) {
+        std::vector<unsigned> vals = draw_classes(workload);
+        double success = double(std::count_if(vals.begin(), vals.end(), succeeds)) / vals.size();
+        StreamEntropy entropy = stream_entropy(vals);
+        data.push_back({ std::move(workload), generate_data(Hierarchy::deep, vals), entropy, success });
+    }
+    return data;
+}
+
+// Cast cost of each implementation against how predictable the stream of classes is
+void run_workload_benchmarks(std::vector<WorkloadData>& workloads)
+{
+    std::vector<const char*> names;
+    std::vector<std::vector<double>> costs;
+
+    print_hierarchy("deep");
+    printf("Classes drawn with varying skew, success ratio and run length, cast to E. The order of the objects is the\n"
+           "stream of classes, so these data sets are not shuffled in run 2.\n\n");
+
+    for (auto& data: workloads) {
+        char title[256];
+        snprintf(title, sizeof(title), "%s (%.2f bits per class, %.2f given the previous one, %.0f%% successful)",
+                 data.workload.name.c_str(), data.entropy.marginal, data.entropy.conditional, data.success * 100);
+        print_data_set(title);
+
+        max_num_ops = 0;
+        data_sets = { DataSet{ &data.objects, nullptr } };
+        names.clear();
+        costs.emplace_back();
+
+        cell.implementation = "static_cast";
+        printf("Base-line: static_cast\n");
+        printf("```\n");
+        run("-", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        printf("```\n\n");
+
+        auto implementation = [&](const char* name, auto cast) {
+            print_implementation(name);
+            printf("```\n");
+            costs.back().push_back(1e9 / run("E", [cast](Objects& v) { return cast_sum<deep::E, &deep::E::e>(v, cast); }));
+            printf("```\n\n");
+            names.push_back(name);
+        };
+        implementation("dynamic_cast",           []<typename T>(A* p) { return dynamic_cast<T*>(p); });
+        implementation("cached_dynamic_cast",    []<typename T>(A* p) { return cached_dynamic_cast<T*>(p); });
+        implementation("vrc::dynamicCast",       []<typename T>(A* p) { return vrc::dynamicCast<T>(p); });
+        // The workloads share one call site, so each owns its cache instead of the one of vrc::cachedDynamicCast
+        vrc::CastCache<deep::E> cache;
+        implementation("vrc::cachedDynamicCast", [&cache]<typename T>(A* p) { return cache.cast(p); });
+        implementation("vrc::flatDynamicCast",   []<typename T>(A* p) { return vrc::flatDynamicCast<T>(p); });
+        implementation("vrc::intervalCast",      []<typename T>(A* p) { return vrc::intervalCast<T>(p); });
+        implementation("kcl_dynamic_cast",       []<typename T>(A* p) { return kcl_dynamic_cast<T*>(p); });
+    }
+
+    printf("Cast cost against the entropy of the stream of classes, in ns per object:\n\n");
+    printf("| Workload | bits | bits given previous | successful |");
+    for (const char* name: names) printf(" `%s` |", name);
+    printf("\n|---|---:|---:|---:|");
+    for (size_t i = 0; i < names.size(); i++) printf("---:|");
+    printf("\n");
+    for (size_t w = 0; w < workloads.size(); w++) {
+        const WorkloadData& data = workloads[w];
+        printf("| %s | %.2f | %.2f | %.0f%% |", data.workload.name.c_str(), data.entropy.marginal,
+               data.entropy.conditional, data.success * 100);
+        for (double ns: costs[w]) printf(" %.2f |", ns);
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// Casts objects of the payload classes of Bytes from random classes B and Leaf (C, or its final twin L) to Leaf,
+// without touching the result, then reading the field next to the vptr, then the one at the far end. The data set
+// lives only for this section, so that objects hundreds of bytes large don't add up over the runs.
+template<size_t Bytes, template<size_t> typename Leaf = payload::C>
+void run_payload_benchmarks(SortOrder order)
+{
+    using C = Leaf<Bytes>;
+    const char* leaf = std::is_final_v<C> ? "L" : "C";
+
+    Arena::Mark mark = arena.mark();
+    {
+        Objects v = place_objects(draw_uniform(0, 1), [](unsigned val) {
+            return val ? make_object<C>() : make_object<payload::B<Bytes>>();
+        });
+        if (order == SortOrder::shuffled) shuffle(v);
+
+        max_num_ops = 0;
+        data_sets = { DataSet{ &v, nullptr } };
+
+        char name[64];
+        snprintf(name, sizeof(name), "payload %zu%s", Bytes, std::is_final_v<C> ? " final" : "");
+        print_hierarchy(name);
+        printf("Objects of %zu and %zu bytes. Rows: `-` casts only and never reads the result, `N` reads the field next\n"
+               "to the vptr, `F` the field %zu bytes further on.\n\n",
+               sizeof(payload::B<Bytes>), sizeof(C), Bytes + sizeof(uint64_t));
+        char title[64];
+        snprintf(title, sizeof(title), "Mixed (cast from random classes B and %s to %s)", leaf, leaf);
+        print_data_set(title);
+
+        cell.implementation = "static_cast";
+        printf("Base-line: static_cast\n");
+        printf("```\n");
+        run("-", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto *p = static_cast <      A*>(e.get()); s += p ? p->a : e->z; } return s; });
+        printf("```\n\n");
+
+        auto implementation = [&](const char* name, auto cast) {
+            print_implementation(name);
+            printf("```\n");
+            run("-", [cast](Objects& v) { return cast_count<C>(v, cast); });
+            run("N", [cast](Objects& v) { return cast_sum<C, &C::near>(v, cast); });
+            run("F", [cast](Objects& v) { return cast_sum<C, &C::far>(v, cast); });
+            printf("```\n\n");
+        };
+        implementation("dynamic_cast",          []<typename T>(A* p) { return dynamic_cast<T*>(p); });
+        implementation("cached_dynamic_cast",   []<typename T>(A* p) { return cached_dynamic_cast<T*>(p); });
+        implementation("vrc::dynamicCast",      []<typename T>(A* p) { return vrc::dynamicCast<T>(p); });
+        implementation("vrc::flatDynamicCast",  []<typename T>(A* p) { return vrc::flatDynamicCast<T>(p); });
+        implementation("kcl_dynamic_cast",      []<typename T>(A* p) { return kcl_dynamic_cast<T*>(p); });
     }
+    arena.rewind(mark);
 }
 
-int main()
+// The usual alternative to vrc::TypeRegistry: a hash map from class names, with heterogeneous lookup so that
+// finding a name allocates nothing
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+using RegistryMap = std::unordered_map<std::string, const vrc::TypeInfo*, NameHash, std::equal_to<>>;
+
+RegistryMap make_registry_map()
 {
+    RegistryMap map;
+    vrc::TypeRegistry::forEach([&](const vrc::TypeInfo& type) { map.emplace(type.name(), &type); });
+    return map;
+}
+
+// Looks up the class of every object of `v` by name or id, as a deserializer does for every message, and constructs
+// an object of that class. The keys are read from the objects, so every row pays the same virtual call for them.
+void run_registry_benchmarks(Objects& v, const char* hierarchy)
+{
+    static const RegistryMap map = make_registry_map();
+
+    max_num_ops = 0;
+    data_sets = { DataSet{ &v, nullptr } };
+
+    print_hierarchy(hierarchy);
+    printf("%llu registered classes\n\n", static_cast<unsigned long long>(vrc::TypeRegistry::size()));
+    print_data_set("Type registry (look up the class of random objects)");
+
+    auto row = [](const char* name, auto kernel) {
+        cell.implementation = name;
+        printf("Implementation: `%s`\n", name);
+        printf("```\n");
+        run("-", kernel);
+        printf("```\n\n");
+    };
+
+    row("unordered_map<string>::find", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) { auto it = map.find(e->typeInfo().name()); s += it != map.end(); } return s; });
+    row("vrc::TypeRegistry::find(name)", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) s += vrc::TypeRegistry::find(e->typeInfo().name()) != nullptr; return s; });
+    row("vrc::TypeRegistry::find(id)", [](Objects& v) { uint64_t s = 0; for (auto&& e: v) s += vrc::TypeRegistry::find(e->typeInfo().id()) != nullptr; return s; });
+    row("unordered_map<string>::find + create", [](Objects& v) {
+        uint64_t s = 0;
+        for (auto&& e: v) { vrc::RttiBase* p = map.find(e->typeInfo().name())->second->create(); s += p != nullptr; delete p; }
+        return s;
+    });
+    row("vrc::TypeRegistry::create(name)", [](Objects& v) {
+        uint64_t s = 0;
+        for (auto&& e: v) { vrc::RttiBase* p = vrc::TypeRegistry::create(e->typeInfo().name()); s += p != nullptr; delete p; }
+        return s;
+    });
+}
+
+int main(int argc, char** argv)
+{
+    bool use_counters = false;
+    bool placement_set = false;
+    const char* json_path = nullptr;
+    const char* csv_path = nullptr;
+    const char* compare_paths[2] = {};
+    double threshold = 0.05;
+    for (int i = 1; i < argc; ++i) {
+        auto name = std::find_if(std::begin(PLACEMENT_NAMES), std::end(PLACEMENT_NAMES),
+                                 [&](const char* name) { return std::strcmp(name, argv[i]) == 0; });
+        if (std::strcmp(argv[i], "--counters") == 0) {
+            use_counters = true;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            compare_paths[0] = argv[++i];
+            compare_paths[1] = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            unsigned threads = unsigned(std::max(std::atoi(argv[++i]), 1));
+            thread_counts.clear();
+            for (unsigned t = 1; t < threads; t *= 2) thread_counts.push_back(t);
+            thread_counts.push_back(threads);
+        } else if (std::strcmp(argv[i], "--private-data") == 0) {
+            private_data = true;
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else if (name != std::end(PLACEMENT_NAMES) && !placement_set) {
+            placement = static_cast<Placement>(name - std::begin(PLACEMENT_NAMES));
+            placement_set = true;
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [heap|packed|clustered|scattered|padded] [--counters] [--json FILE] [--csv FILE]\n"
+                    "       %*s [--threads N [--private-data]]\n"
+                    "       %s --compare OLD.json NEW.json [--threshold FRACTION]\n",
+                    argv[0], int(std::strlen(argv[0])), "", argv[0]);
+            return 2;
+        }
+    }
+
+    if (compare_paths[0]) {
+        int slower = compare_results(compare_paths[0], compare_paths[1], threshold);
+        return slower < 0 ? 2 : slower > 0 ? 1 : 0;
+    }
+
+    PerfCounters perf_counters;
+    if (use_counters) {
+        if (perf_counters.open()) counters = &perf_counters;
+        else fprintf(stderr, "Hardware counters are unavailable, continuing without them\n");
+    }
+
+    printf("Object placement: %s\n", PLACEMENT_NAMES[static_cast<int>(placement)]);
+    printf("Type ids: vrc %d bits, KCL %d bits\n", VRC_TYPE_ID_BITS, KCL_RTTI_TYPE_ID_BITS);
+
+    calibrate_timer();
+
     auto vec_deep_successful = generate_data(Hierarchy::deep, 6, 0);
     auto vec_deep_fails = generate_data(Hierarchy::deep, 1, 0);
     auto vec_deep_mixed = generate_data(Hierarchy::deep, 0, 7);
@@ -490,12 +2378,20 @@ int main()
     auto vec_cross_most = generate_data(Hierarchy::cross, 6, 0);
     auto vec_cross_mixed = generate_data(Hierarchy::cross, 5, 2);
 
+    auto vec_workloads = generate_workloads();
+
+    auto vec_synthetic = std::apply([](auto... h) {
+        return std::array<Objects, sizeof...(h)>{ generate_synthetic_data<decltype(h)>()... };
+    }, SyntheticHierarchies{});
+
     // Run the benchmark loop 3 times:
     // 1st: Warming up, discard.
     // 2nd: Objects are ordered in memory
     // 3rd: Objects are shuffled in memory
     for (unsigned i = 0; i < 3; i++) {
+        const SortOrder order = i == 2 ? SortOrder::shuffled : SortOrder::aligned;
         max_num_ops = 0;
+        cell.run = i;
 
         printf("\n\n\n\n\n");
 
@@ -520,10 +2416,12 @@ int main()
                 shuffle(vec_cross_all);
                 shuffle(vec_cross_most);
                 shuffle(vec_cross_mixed);
+
+                for (auto& v: vec_synthetic) shuffle(v);
                 break;
         }
 
-        printf("### Class hierarchy: cross\n\n");
+        print_hierarchy("cross");
 
         printf("```\n");
         printf("[A]-+   C -+   E -+\n");
@@ -534,34 +2432,34 @@ int main()
         printf("\nZ - unrelated\n");
         printf("```\n");
 
-        printf("#### Cast type: All successful (cast from class H)\n\n");
+        print_data_set("All successful (cast from class H)");
         run_benchmarks(vec_cross_all, Hierarchy::cross);
 
-        printf("#### Cast type: Mostly successful (cast from class G)\n\n");
+        print_data_set("Mostly successful (cast from class G)");
         run_benchmarks(vec_cross_most, Hierarchy::cross);
 
-        printf("#### Cast type: Mixed (cast from random classes F, G, or H)\n\n");
+        print_data_set("Mixed (cast from random classes F, G, or H)");
         run_benchmarks(vec_cross_mixed, Hierarchy::cross);
 
-        printf("### Class hierarchy: deep\n\n");
+        print_hierarchy("deep");
 
         printf("```\n");
         printf("[A]---> B ---> C ---> D ---> E ---> F ---> G ---> H\n");
         printf("\nZ - unrelated\n");
         printf("```\n");
 
-        printf("#### Cast type: Mostly successful (cast from class G)\n\n");
+        print_data_set("Mostly successful (cast from class G)");
         run_benchmarks(vec_deep_successful, Hierarchy::deep);
 
-        printf("#### Cast type: Mostly failed (cast from class B)\n\n");
+        print_data_set("Mostly failed (cast from class B)");
         run_benchmarks(vec_deep_fails, Hierarchy::deep);
 
-        printf("#### Cast type: Mixed (cast from random classes)\n\n");
+        print_data_set("Mixed (cast from random classes)");
         run_benchmarks(vec_deep_mixed, Hierarchy::deep);
 
 
         printf("\n\n\n\n\n");
-        printf("### Class hierarchy: shallow\n\n");
+        print_hierarchy("shallow");
 
         printf("```\n");
         printf("    +-> B\n");
@@ -580,18 +2478,18 @@ int main()
         printf("\nZ - unrelated\n");
         printf("```\n");
 
-        printf("#### Cast type: Mostly successful (cast from class G)\n\n");
+        print_data_set("Mostly successful (cast from class G)");
         run_benchmarks(vec_shallow_successful, Hierarchy::shallow);
 
-        printf("#### Cast type: Mostly failed (cast from class B)\n\n");
+        print_data_set("Mostly failed (cast from class B)");
         run_benchmarks(vec_shallow_fails, Hierarchy::shallow);
 
-        printf("#### Cast type: Mixed (cast from random classes)\n\n");
+        print_data_set("Mixed (cast from random classes)");
         run_benchmarks(vec_shallow_mixed, Hierarchy::shallow);
 
 
         printf("\n\n\n\n\n");
-        printf("### Class hierarchy: balanced\n\n");
+        print_hierarchy("balanced");
 
         printf("```\n");
         printf("    +-> B -+-> C\n");
@@ -606,8 +2504,29 @@ int main()
         printf("\nZ - unrelated\n");
         printf("```\n");
 
-        printf("#### Cast type: Mixed (cast from random classes)\n\n");
+        print_data_set("Mixed (cast from random classes)");
         run_benchmarks(vec_balanced_mixed, Hierarchy::balanced);
+
+        std::apply([&](auto... h) {
+            size_t index = 0;
+            ((printf("\n\n\n\n\n"), run_synthetic_benchmarks(vec_synthetic[index++], h)), ...);
+        }, SyntheticHierarchies{});
+
+        printf("\n\n\n\n\n");
+        run_workload_benchmarks(vec_workloads);
+
+        printf("\n\n\n\n\n");
+        run_payload_benchmarks<64>(order);
+        run_payload_benchmarks<256>(order);
+        run_payload_benchmarks<64, payload::L>(order);
+        run_payload_benchmarks<256, payload::L>(order);
+
+        printf("\n\n\n\n\n");
+        run_registry_benchmarks(vec_deep_mixed, "deep");
+        std::apply([&](auto... h) {
+            size_t index = 0;
+            (run_registry_benchmarks(vec_synthetic[index++], decltype(h)::NAME), ...);
+        }, SyntheticHierarchies{});
     }
 
     printf("\n\n\n\n\n");
@@ -615,5 +2534,31 @@ int main()
     printf("sizeof JustVrcRtti: %llu\n\n", static_cast<unsigned long long>(sizeof(JustVrcRtti)));
     printf("sizeof JustRtti: %llu\n\n", static_cast<unsigned long long>(sizeof(JustRtti)));
     printf("sizeof A: %llu\n\n", static_cast<unsigned long long>(sizeof(A)));
+    printf("Reference counting per object: std::shared_ptr %llu + control block %llu bytes, vrc::Ref %llu + count %llu bytes in A\n\n",
+           static_cast<unsigned long long>(sizeof(std::shared_ptr<A>)), static_cast<unsigned long long>(control_block_size()),
+           static_cast<unsigned long long>(sizeof(vrc::Ref<A>)),
+           static_cast<unsigned long long>(sizeof(vrc::RttiBase) - sizeof(void*)));
+    print_metadata_size("the hand-written hierarchies", metadata_size<A, deep::B, deep::C, deep::D, deep::E, deep::F, deep::G, deep::H,
+                                          shallow::B, shallow::C, shallow::D, shallow::E, shallow::F, shallow::G, shallow::H,
+                                          balanced::B, balanced::C, balanced::D, balanced::E, balanced::F, balanced::G, balanced::H,
+                                          cross::B, cross::C, cross::D, cross::E, cross::F, cross::G, cross::H, Z>());
+    std::apply([](auto... h) {
+        (print_metadata_size(decltype(h)::NAME, synthetic_metadata_size<decltype(h)>()), ...);
+    }, SyntheticHierarchies{});
     printf("%f", dummy);
+
+    // Results that can't be written fail the run, so that scripts don't go on comparing a stale or truncated file
+    int status = 0;
+    auto write_results = [&status](const char* path, void (*write)(std::ostream&)) {
+        std::ofstream out(path);
+        if (out) write(out);
+        out.close();
+        if (!out) {
+            fprintf(stderr, "Can't write %s\n", path);
+            status = 2;
+        }
+    };
+    if (json_path) write_results(json_path, write_json);
+    if (csv_path) write_results(csv_path, write_csv);
+    return status;
 }
@@ -124,6 +124,14 @@
 #	error Not implemented for this compiler
 #endif
 
+// SIMD instruction sets enabled for the current target
+#if defined(__AVX2__)
+#	define KCL_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define KCL_SIMD_SSE2 1
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 // C++ Language Support
 //////////////////////////////////////////////////////////////////////////
@@ -23,20 +23,43 @@
 #pragma once
 
 #include <cstdint>
-#include <cstring>
 #include <memory>
+#include <string_view>
 #include <type_traits>
 
 #include "KCL_Platform.h"
+#include "KCL_Utils_Hash.h"
 #include "KCL_Utils_Preprocessor.h"
 
+// Set to 0 to force the scalar type id scan in TypeInfo::CastTo
+#if !defined(KCL_RTTI_SIMD)
+#	define KCL_RTTI_SIMD 1
+#endif
+
+// Width of type ids in bits: 16, 32 or 64. Narrower ids keep the type tables small, but make it more likely that two
+// registered names hash to the same id
+#if !defined(KCL_RTTI_TYPE_ID_BITS)
+#	define KCL_RTTI_TYPE_ID_BITS 32
+#endif
+static_assert(KCL_RTTI_TYPE_ID_BITS == 16 || KCL_RTTI_TYPE_ID_BITS == 32 || KCL_RTTI_TYPE_ID_BITS == 64,
+			  "KCL_RTTI_TYPE_ID_BITS must be 16, 32 or 64");
+
+#if KCL_RTTI_SIMD && defined(KCL_SIMD_AVX2)
+#	include <immintrin.h>
+#elif KCL_RTTI_SIMD && defined(KCL_SIMD_SSE2)
+#	include <emmintrin.h>
+#endif
+
 // Minimalistic and efficient RTTI Implementation.
 // Adds virtual methods to registered types, as polymorphism is necessary
 // Dynamic casts cost in the worst case one virtual call and walking through a data buffer
 
 // Note:
-// * This is not safe to pass across boundaries.
-// * This is not thread safe. The type info is created the first time it is accessed, race conditions may occur.
+// * Type ids are hashes of the registered type names, so register types with the same spelling everywhere,
+//   e.g. fully qualified, and don't register two types under the same name.
+// * All type info is constant data built at compile time, there is no guard to check. Only the offsets of secondary
+//   base subobjects are set by dynamic initialization; casts made before it adjust through a function instead.
+// * Base types must be registered before the types derived from them.
 
 /*Usage :
 
@@ -60,8 +83,9 @@ namespace KCL
 // Details, this is not meant to be used outside of this file
 namespace RTTI_Private
 {
-// You can reduce the size at will here
-typedef uint32_t typeId_t;
+typedef std::conditional_t<KCL_RTTI_TYPE_ID_BITS == 16, uint16_t,
+						   std::conditional_t<KCL_RTTI_TYPE_ID_BITS == 32, uint32_t, uint64_t>>
+	typeId_t;
 
 // Member ::Get() will return const TypeInfo*
 template<typename T>
@@ -69,6 +93,90 @@ struct GetTypeInfo
 {
 };
 
+// Type data is read in whole SIMD registers, this many bytes may be read past the end of the last type id list
+#if KCL_RTTI_SIMD && defined(KCL_SIMD_AVX2)
+constexpr size_t ourTypeDataPadding = sizeof(__m256i);
+#elif KCL_RTTI_SIMD && defined(KCL_SIMD_SSE2)
+constexpr size_t ourTypeDataPadding = sizeof(__m128i);
+#else
+constexpr size_t ourTypeDataPadding = 1;
+#endif
+
+// SSE2 has no 64-bit compare, 64-bit ids are scanned one by one there
+#if KCL_RTTI_SIMD && defined(KCL_SIMD_AVX2)
+constexpr bool ourSimdTypeIds = true;
+#elif KCL_RTTI_SIMD && defined(KCL_SIMD_SSE2)
+constexpr bool ourSimdTypeIds = sizeof(typeId_t) < 8;
+#else
+constexpr bool ourSimdTypeIds = false;
+#endif
+
+// Returns a bit per byte of the ourTypeDataPadding bytes at aData, set for the bytes of the ids equal to aTypeId
+KCL_FORCEINLINE uint32_t MatchTypeIds(const char* aData, typeId_t aTypeId)
+{
+#if KCL_RTTI_SIMD && defined(KCL_SIMD_AVX2)
+	const __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aData));
+	__m256i equal;
+	if constexpr (sizeof(typeId_t) == 2)
+		equal = _mm256_cmpeq_epi16(ids, _mm256_set1_epi16((short)aTypeId));
+	else if constexpr (sizeof(typeId_t) == 4)
+		equal = _mm256_cmpeq_epi32(ids, _mm256_set1_epi32((int)aTypeId));
+	else
+		equal = _mm256_cmpeq_epi64(ids, _mm256_set1_epi64x((long long)aTypeId));
+	return (uint32_t)_mm256_movemask_epi8(equal);
+#elif KCL_RTTI_SIMD && defined(KCL_SIMD_SSE2)
+	const __m128i ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aData));
+	__m128i equal;
+	if constexpr (sizeof(typeId_t) == 2)
+		equal = _mm_cmpeq_epi16(ids, _mm_set1_epi16((short)aTypeId));
+	else
+		equal = _mm_cmpeq_epi32(ids, _mm_set1_epi32((int)aTypeId));
+	return (uint32_t)_mm_movemask_epi8(equal);
+#else
+	(void)aData;
+	(void)aTypeId;
+	return 0;
+#endif
+}
+
+// Returns true if aTypeId is one of the aSize type ids starting at aData
+KCL_FORCEINLINE bool FindTypeId(const char* aData, uint32_t aSize, typeId_t aTypeId)
+{
+	if constexpr (ourSimdTypeIds)
+	{
+		// Ids are packed and unaligned: use unaligned loads and mask out the bytes past the end of the list,
+		// which belong to the following list or to the padding
+		const uint32_t bytes = aSize * (uint32_t)sizeof(typeId_t);
+		for (uint32_t i = 0; i < bytes; i += (uint32_t)ourTypeDataPadding)
+		{
+			uint32_t mask = MatchTypeIds(aData + i, aTypeId);
+			const uint32_t left = bytes - i;
+			if (left < ourTypeDataPadding)
+				mask &= (1u << left) - 1;
+			if (mask != 0)
+				return true;
+		}
+		return false;
+	}
+	for (uint32_t i = 0; i < aSize; i++)
+	{
+		if (reinterpret_cast<const typeId_t*>(aData)[i] == aTypeId)
+			return true;
+	}
+	return false;
+}
+
+// Hash of the registered type name, the same as vrc's, folded to the width of typeId_t
+constexpr typeId_t HashTypeName(const char* aName)
+{
+	uint64_t hash = KCL::Hash64(aName, std::char_traits<char>::length(aName));
+	if constexpr (sizeof(typeId_t) < 8)
+		hash ^= hash >> 32;
+	if constexpr (sizeof(typeId_t) < 4)
+		hash ^= hash >> 16;
+	return (typeId_t)hash;
+}
+
 } // namespace RTTI_Private
 
 // Public RTTI API
@@ -76,41 +184,47 @@ namespace RTTI
 {
 typedef KCL::RTTI_Private::typeId_t typeId_t;
 
+// Adjusts a pointer to the registered type to one of its base subobjects
+typedef intptr_t (*AdjustFunction)(intptr_t aPtr);
+
+// A run of type ids sharing the same base subobject: the ids of a type and of its chain of first bases
+struct TypeBlock
+{
+	uint32_t myIndex;
+	uint32_t mySize;
+};
+
 // Interface of TypeInfo
 struct TypeInfo
 {
 	KCL_FORCEINLINE const char* GetName() const { return myName; }
-	KCL_FORCEINLINE const char* GetTypeData() const { return (char*)(this + 1); }
-	KCL_FORCEINLINE typeId_t GetTypeId() const { return *(typeId_t*)(GetTypeData() + sizeof(typeId_t)); }
+	KCL_FORCEINLINE typeId_t GetTypeId() const { return myTypeId; }
 	inline intptr_t CastTo(intptr_t aPtr, typeId_t aTypeId) const
 	{
-		const char* data = GetTypeData();
-		size_t byteIndex = 0;
-		ptrdiff_t offset = 0;
-
-		while (true)
+		for (uint32_t i = 0; i < myBlockCount; i++)
 		{
-			typeId_t size = *reinterpret_cast<const typeId_t*>(data + byteIndex);
-			byteIndex += sizeof(typeId_t);
-
-			for (typeId_t i = 0; i < size; i++, byteIndex += sizeof(typeId_t))
+			const TypeBlock& block = myBlocks[i];
+			if (KCL::RTTI_Private::FindTypeId(reinterpret_cast<const char*>(myTypeIds + block.myIndex), block.mySize, aTypeId))
 			{
-				if (*reinterpret_cast<const typeId_t*>(data + byteIndex) == aTypeId)
-					return aPtr + offset;
+				const ptrdiff_t offset =
+					myHasShortOffsets ? static_cast<const int16_t*>(myOffsets)[i] : static_cast<const int32_t*>(myOffsets)[i];
+				return offset ? aPtr + offset - 1 : myAdjusts[i](aPtr);
 			}
-
-			offset = *reinterpret_cast<const ptrdiff_t*>(data + byteIndex);
-			if (offset == 0)
-				return 0;
-
-			byteIndex += sizeof(ptrdiff_t);
 		}
+		return 0;
 	}
 
 	KCL_FORCEINLINE bool operator==(const TypeInfo& anOther) const { return GetTypeId() == anOther.GetTypeId(); }
 	KCL_FORCEINLINE bool operator!=(const TypeInfo& anOther) const { return GetTypeId() != anOther.GetTypeId(); }
 
 	const char* myName;
+	typeId_t myTypeId;
+	uint32_t myBlockCount;
+	bool myHasShortOffsets; // Offsets are int16_t rather than int32_t
+	const typeId_t* myTypeIds; // All blocks back to back, followed by ourTypeDataPadding bytes
+	const TypeBlock* myBlocks;
+	const void* myOffsets; // Offset of the base subobject of each block plus one, zero until dynamic initialization
+	const AdjustFunction* myAdjusts; // Only called before the offsets are set
 };
 
 // Public interface to access type information
@@ -125,9 +239,27 @@ KCL_FORCEINLINE const TypeInfo* GetTypeInfo()
 template<typename T>
 KCL_FORCEINLINE typeId_t GetTypeId()
 {
-	return GetTypeInfo<T>()->GetTypeId();
+	typedef typename std::decay<typename std::remove_cv<T>::type>::type Type;
+	return KCL::RTTI_Private::GetTypeInfo<Type>::ourTypeId;
 }
 
+// Casts only if Derived is the most derived type of the object: compares its type info, without walking the type data
+template<typename Derived, typename Base>
+KCL_FORCEINLINE Derived ExactCast(Base* aBasePtr)
+{
+	static_assert(std::is_pointer<Derived>::value, "Return type must be a pointer");
+	typedef typename std::remove_pointer<Derived>::type DerivedObjectType;
+
+	// Type info addresses can't collide, unlike narrow hashed ids
+	if (!aBasePtr || aBasePtr->KCL_RTTI_GetTypeInfo() != GetTypeInfo<DerivedObjectType>())
+		return nullptr;
+	if constexpr (requires { static_cast<Derived>(aBasePtr); })
+		return static_cast<Derived>(aBasePtr);
+	else
+		return reinterpret_cast<Derived>(aBasePtr->KCL_RTTI_DynamicCast(GetTypeId<DerivedObjectType>()));
+}
+
+// Casts to final types go through ExactCast
 template<typename Derived, typename Base>
 KCL_FORCEINLINE Derived DynamicCast(Base* aBasePtr)
 {
@@ -136,6 +268,8 @@ KCL_FORCEINLINE Derived DynamicCast(Base* aBasePtr)
 
 	if constexpr (std::is_base_of<DerivedObjectType, Base>::value)
 		return static_cast<Derived>(aBasePtr);
+	else if constexpr (std::is_final<DerivedObjectType>::value)
+		return ExactCast<Derived>(aBasePtr);
 	else if (aBasePtr)
 		return reinterpret_cast<Derived>(aBasePtr->KCL_RTTI_DynamicCast(GetTypeId<DerivedObjectType>()));
 	else
@@ -155,152 +289,330 @@ struct Base
 
 namespace RTTI_Private
 {
-static typeId_t GenerateId()
+template<typename... Types>
+struct TypeList
 {
-	// magic number that increases every time it is called
-	static typeId_t theTypeIdCounter = 0;
-	return ++theTypeIdCounter;
-}
+};
 
-template<typename Derived, typename Base>
-static ptrdiff_t ComputePointerOffset()
+template<typename... Lists>
+struct Concat
 {
-	Derived* derivedPtr = (Derived*)1;
-	Base* basePtr = static_cast<Base*>(derivedPtr);
-	return (intptr_t)basePtr - (intptr_t)derivedPtr;
-}
+	typedef TypeList<> Type;
+};
 
-#pragma pack(push, 1)
+template<typename... Types, typename... Lists>
+struct Concat<TypeList<Types...>, Lists...>
+{
+	typedef typename Concat<Lists...>::Type Next;
+	typedef typename Concat<TypeList<Types...>, Next>::Type Type;
+};
 
-// Specialization will contain the magic data.
+template<typename... Types, typename... Others>
+struct Concat<TypeList<Types...>, TypeList<Others...>>
+{
+	typedef TypeList<Types..., Others...> Type;
+};
+
+// Specialization will list the direct bases.
 template<typename T>
 struct TypeData
 {
 };
 
-// Recursively populates the typeData
-// Layout of typeData:
-// [ typeId_t size, typeId_t firstTypeId ... typeId_t lastTypeId, ptrdiff_t offset/endMarker if = 0,
-// typeId_t size, typeId_t firstTypeId ... typeId_t lastTypeId, ptrdiff_t offset/endMarker if = 0... ]
-// Each block represents inherited types from a base, the first block doesn't need offset as it is implicitly 0
-// Therefore we can use the offset as an end marker, all other bases will have a positive offset
-template<typename... BaseTypes>
-struct BaseTypeData
+template<typename Type, typename... BaseTypes>
+struct TypeDataImpl
 {
+	typedef TypeList<BaseTypes...> Bases;
 };
 
-template<typename Type>
-struct BaseTypeData<std::enable_shared_from_this<Type>>
+// Computes the type blocks of a type at compile time
+// Layout of the blocks:
+// [ Type, firstBase, firstBase's firstBase... ] [ secondBase, secondBase's firstBase... ] ...
+// Each block represents inherited types from a base, Path is the list of bases to static_cast through to reach it
+// from the registered type; the first block's path is empty as it shares its address
+template<typename Path, typename Chain>
+struct BlockDesc
 {
-	template<typename Derived>
-	void FillBaseTypeData(std::ptrdiff_t, typeId_t&)
-	{
-	}
 };
 
-template<typename FirstBase, typename SecondBase, typename... Next>
-struct BaseTypeData<FirstBase, SecondBase, Next...>
+template<typename Base, typename Blocks>
+struct PrependPath
 {
-	template<typename Derived>
-	void FillBaseTypeData(ptrdiff_t aOffset, typeId_t& outHeadSize)
-	{
-		myFirst.template FillBaseTypeData<Derived>(ComputePointerOffset<Derived, FirstBase>(), outHeadSize);
-
-		myOffset = ComputePointerOffset<Derived, SecondBase>();
-		myNext.template FillBaseTypeData<Derived>(myOffset, mySize);
-	}
+};
 
-	BaseTypeData<FirstBase> myFirst;
-	ptrdiff_t myOffset;
-	typeId_t mySize;
-	BaseTypeData<SecondBase, Next...> myNext;
+template<typename Base, typename... Paths, typename... Chains>
+struct PrependPath<Base, TypeList<BlockDesc<Paths, Chains>...>>
+{
+	typedef TypeList<BlockDesc<typename Concat<TypeList<Base>, Paths>::Type, Chains>...> Type;
 };
 
+template<typename T>
+struct Blocks;
+
 template<typename Base>
-struct BaseTypeData<Base>
+struct BaseBlocks
 {
-	template<typename Derived>
-	void FillBaseTypeData(ptrdiff_t aOffset, typeId_t& outHeadSize)
-	{
-		const TypeData<Base>* baseTypeId = (TypeData<Base>*)(GetTypeInfo<Base>::Get()->GetTypeData());
+	typedef typename Blocks<Base>::Type Type;
+};
 
-		// return size of head list
-		outHeadSize = baseTypeId->mySize;
+template<typename T>
+struct BaseBlocks<std::enable_shared_from_this<T>>
+{
+	typedef TypeList<> Type;
+};
 
-		const char* data = baseTypeId->GetData();
-		size_t byteSize = baseTypeId->mySize * sizeof(typeId_t);
+// Type joins the first block of its first base
+template<typename T, typename FirstBase, typename FirstBaseBlocks>
+struct HeadBlocks
+{
+	typedef TypeList<BlockDesc<TypeList<>, TypeList<T>>> Type;
+};
 
-		// copy type list
-		memcpy(myData, data, byteSize);
+template<typename T, typename FirstBase, typename... Chain, typename... Next>
+struct HeadBlocks<T, FirstBase, TypeList<BlockDesc<TypeList<>, TypeList<Chain...>>, Next...>>
+{
+	typedef typename Concat<TypeList<BlockDesc<TypeList<>, TypeList<T, Chain...>>>,
+							typename PrependPath<FirstBase, TypeList<Next...>>::Type>::Type Type;
+};
 
-		size_t byteIndex = byteSize;
-		ptrdiff_t offset = *reinterpret_cast<const ptrdiff_t*>(data + byteIndex);
-		while (offset != 0)
-		{
-			// fill next offset and add pointer offset
-			*reinterpret_cast<ptrdiff_t*>(myData + byteIndex) = offset + aOffset;
-			byteIndex += sizeof(ptrdiff_t);
+template<typename T, typename Bases>
+struct BlocksImpl
+{
+	typedef TypeList<BlockDesc<TypeList<>, TypeList<T>>> Type;
+};
 
-			// fill next size
-			const typeId_t size = *reinterpret_cast<const typeId_t*>(data + byteIndex);
-			*reinterpret_cast<typeId_t*>(myData + byteIndex) = size;
-			byteSize = size * sizeof(typeId_t);
-			byteIndex += sizeof(typeId_t);
+template<typename T, typename FirstBase, typename... NextBases>
+struct BlocksImpl<T, TypeList<FirstBase, NextBases...>>
+{
+	typedef typename Concat<typename HeadBlocks<T, FirstBase, typename BaseBlocks<FirstBase>::Type>::Type,
+							typename PrependPath<NextBases, typename BaseBlocks<NextBases>::Type>::Type...>::Type Type;
+};
 
-			// copy types
-			memcpy(myData + byteIndex, data + byteIndex, byteSize);
-			byteIndex += byteSize;
+template<typename T>
+struct Blocks
+{
+	typedef typename BlocksImpl<T, typename TypeData<T>::Bases>::Type Type;
+};
 
-			offset = *reinterpret_cast<const ptrdiff_t*>(data + byteIndex);
-		}
-	}
+template<typename From, typename... Path>
+struct Upcast
+{
+	static KCL_FORCEINLINE From* Apply(From* aPtr) { return aPtr; }
+};
 
-	// We only need the previous type data array, but not its size or end marker
-	char myData[sizeof(TypeData<Base>) - sizeof(ptrdiff_t) - sizeof(typeId_t)];
+template<typename From, typename To, typename... Path>
+struct Upcast<From, To, Path...>
+{
+	static KCL_FORCEINLINE auto Apply(From* aPtr) { return Upcast<To, Path...>::Apply(static_cast<To*>(aPtr)); }
 };
 
-// Actual implementation of TypeData<Type>
-template<typename Type, typename... BaseTypes>
-struct TypeDataImpl
+template<typename Type, typename Path>
+struct Adjuster
 {
-	TypeDataImpl()
+	static intptr_t Adjust(intptr_t aPtr) { return aPtr; }
+};
+
+template<typename Type, typename First, typename... Path>
+struct Adjuster<Type, TypeList<First, Path...>>
+{
+	static intptr_t Adjust(intptr_t aPtr) { return (intptr_t)Upcast<Type, First, Path...>::Apply((Type*)aPtr); }
+};
+
+// Pointer conversions between subobjects are not constant expressions, so the offset is measured on a fake (never
+// dereferenced) object address when the program starts, and stored plus one so that zero means not measured yet
+template<typename Type, typename Path>
+ptrdiff_t StoredOffset()
+{
+	const intptr_t address = (intptr_t)alignof(Type) << 8;
+	return Adjuster<Type, Path>::Adjust(address) - address + 1;
+}
+
+// Type ids and blocks of a type, built at compile time
+template<typename T, typename BlockList = typename Blocks<T>::Type>
+struct TypeTable
+{
+};
+
+template<typename T, typename... Paths, typename... Chains>
+struct TypeTable<T, TypeList<BlockDesc<Paths, Chains>...>>
+{
+	template<typename... Types>
+	static constexpr size_t Count(TypeList<Types...>)
 	{
-		myTypeId = GenerateId();
-		myBaseTypeData.template FillBaseTypeData<Type>(0 /* No offset with first base */, mySize);
-		mySize++; // Size is the base's size + 1 to account for current type id
-		myEndMarker = 0;
+		return sizeof...(Types);
 	}
 
-	const char* GetData() const { return (char*)&myTypeId; }
+	static constexpr size_t ourIdCount = (Count(Chains()) + ...);
+	static constexpr size_t ourBlockCount = sizeof...(Chains);
 
-	typeId_t mySize;
-	typeId_t myTypeId;
-	BaseTypeData<BaseTypes...> myBaseTypeData;
-	ptrdiff_t myEndMarker;
+	constexpr TypeTable()
+	{
+		static_assert(HasDistinctIds(), "Two ancestors have the same type id: use wider ids (KCL_RTTI_TYPE_ID_BITS)");
+		uint32_t index = 0;
+		uint32_t block = 0;
+		(AddBlock(Chains(), index, block), ...);
+	}
+
+	template<typename... Types>
+	static constexpr void AddNames(TypeList<Types...>, typeId_t* someIds, const char** someNames, size_t& anIndex)
+	{
+		((someIds[anIndex] = GetTypeInfo<Types>::ourTypeId, someNames[anIndex++] = GetTypeInfo<Types>::ourName), ...);
+	}
+
+	// A base repeated through several paths has its id several times, but two distinct types may not share one,
+	// or a cast to one of them would return the other
+	static constexpr bool HasDistinctIds()
+	{
+		typeId_t ids[ourIdCount] = {};
+		const char* names[ourIdCount] = {};
+		size_t index = 0;
+		(AddNames(Chains(), ids, names, index), ...);
+		for (size_t i = 0; i < ourIdCount; i++)
+		{
+			for (size_t j = 0; j < i; j++)
+			{
+				if (ids[i] == ids[j] && names[i] != names[j])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename... Types>
+	constexpr void AddBlock(TypeList<Types...>, uint32_t& anIndex, uint32_t& aBlock)
+	{
+		myBlocks[aBlock++] = {anIndex, (uint32_t)sizeof...(Types)};
+		((myIds[anIndex++] = GetTypeInfo<Types>::ourTypeId), ...);
+	}
+
+	typeId_t myIds[ourIdCount] = {};
+	char myPadding[ourTypeDataPadding] = {};
+	RTTI::TypeBlock myBlocks[ourBlockCount] = {};
 };
 
-template<typename Type>
-struct TypeDataImpl<Type>
-{
-	TypeDataImpl() : mySize(1), myTypeId(GenerateId()), myEndMarker(0) {}
+// Stored offsets take two bytes when the type is small enough, as most are
+template<typename T>
+using OffsetType = std::conditional_t<(sizeof(T) < INT16_MAX), int16_t, int32_t>;
 
-	const char* GetData() const { return (char*)&myTypeId; }
+// Base subobject offsets of the blocks of a type, see StoredOffset, and the functions used until they are set. These
+// are kept apart from the blocks, which a cast scans, as they are only read once a block matched.
+template<typename T, typename BlockList = typename Blocks<T>::Type>
+struct TypeOffsets
+{
+};
 
-	typeId_t mySize;
-	typeId_t myTypeId;
-	ptrdiff_t myEndMarker;
+template<typename T, typename... Paths, typename... Chains>
+struct TypeOffsets<T, TypeList<BlockDesc<Paths, Chains>...>>
+{
+	static inline const OffsetType<T> ourOffsets[sizeof...(Paths)] = {(OffsetType<T>)StoredOffset<T, Paths>()...};
+	static constexpr RTTI::AdjustFunction ourAdjusts[sizeof...(Paths)] = {&Adjuster<T, Paths>::Adjust...};
 };
 
 template<typename T>
 struct TypeInfoImpl
 {
-	const RTTI::TypeInfo myInfo;
-	const TypeData<T> myData;
+	static constexpr TypeTable<T> ourTable{};
+	static constexpr RTTI::TypeInfo ourInfo = {
+		GetTypeInfo<T>::ourName, GetTypeInfo<T>::ourTypeId, (uint32_t)TypeTable<T>::ourBlockCount, std::is_same<OffsetType<T>, int16_t>::value,
+		ourTable.myIds, ourTable.myBlocks, TypeOffsets<T>::ourOffsets, TypeOffsets<T>::ourAdjusts};
 };
 
-#pragma pack(pop)
+template<typename T>
+KCL_FORCEINLINE T* ToPointer(T* aPtr)
+{
+	return aPtr;
+}
+
+template<typename SmartPtr>
+KCL_FORCEINLINE auto ToPointer(const SmartPtr& aPtr) -> decltype(aPtr.get())
+{
+	return aPtr.get();
+}
+
+// Direct-mapped cache of cast results keyed on the vtable of the source object, private to one batch
+template<typename Derived>
+struct BatchCastCache
+{
+	static constexpr size_t ourSize = 16;
+	static constexpr ptrdiff_t ourFailed = PTRDIFF_MIN;
+
+	struct Entry
+	{
+		const void* myVTable = nullptr;
+		ptrdiff_t myOffset = 0;
+	};
+
+	template<typename Base>
+	KCL_FORCEINLINE Derived Cast(Base* aBasePtr)
+	{
+		typedef typename std::remove_pointer<Derived>::type DerivedObjectType;
+
+		if constexpr (std::is_base_of<DerivedObjectType, Base>::value)
+			return static_cast<Derived>(aBasePtr);
+		else
+		{
+			if (!aBasePtr)
+				return nullptr;
+
+			const void* vtable = *reinterpret_cast<const void* const*>(aBasePtr);
+			Entry& entry = myEntries[(reinterpret_cast<uintptr_t>(vtable) / sizeof(void*)) % ourSize];
+			if (entry.myVTable != vtable)
+			{
+				const intptr_t result = aBasePtr->KCL_RTTI_DynamicCast(KCL::RTTI::GetTypeId<DerivedObjectType>());
+				entry.myVTable = vtable;
+				entry.myOffset = result ? result - (intptr_t)aBasePtr : ourFailed;
+			}
+			return entry.myOffset != ourFailed ? reinterpret_cast<Derived>((intptr_t)aBasePtr + entry.myOffset) : nullptr;
+		}
+	}
+
+	Entry myEntries[ourSize];
+};
 
 } // namespace RTTI_Private
+
+namespace RTTI
+{
+// Casts the pointers (raw or smart) in [aBegin, aEnd) to Derived, resolving each distinct type once per batch
+// Writes the successful casts to outPtrs in order and returns their count
+template<typename Derived, typename Iterator>
+size_t DynamicCastBatch(Iterator aBegin, Iterator aEnd, Derived* outPtrs)
+{
+	static_assert(std::is_pointer<Derived>::value, "Return type must be a pointer");
+
+	KCL::RTTI_Private::BatchCastCache<Derived> cache;
+	size_t count = 0;
+	for (; aBegin != aEnd; ++aBegin)
+	{
+		if (Derived result = cache.Cast(KCL::RTTI_Private::ToPointer(*aBegin)))
+			outPtrs[count++] = result;
+	}
+	return count;
+}
+
+// Same as DynamicCastBatch, but sets bit (i % 64) of outMask[i / 64] if the i-th pointer casts to Derived
+template<typename Derived, typename Iterator>
+void DynamicCastBatchMask(Iterator aBegin, Iterator aEnd, uint64_t* outMask)
+{
+	static_assert(std::is_pointer<Derived>::value, "Return type must be a pointer");
+
+	KCL::RTTI_Private::BatchCastCache<Derived> cache;
+	size_t index = 0;
+	uint64_t bits = 0;
+	for (; aBegin != aEnd; ++aBegin, ++index)
+	{
+		if (cache.Cast(KCL::RTTI_Private::ToPointer(*aBegin)))
+			bits |= uint64_t(1) << (index % 64);
+		if (index % 64 == 63)
+		{
+			*outMask++ = bits;
+			bits = 0;
+		}
+	}
+	if (index % 64 != 0)
+		*outMask = bits;
+}
+} // namespace RTTI
 } // namespace KCL
 
 template<typename Derived, typename Base>
@@ -309,16 +621,27 @@ KCL_FORCEINLINE Derived kcl_dynamic_cast(Base* aBasePtr)
 	return KCL::RTTI::DynamicCast<Derived, Base>(aBasePtr);
 }
 
+template<typename Derived, typename Base>
+KCL_FORCEINLINE Derived kcl_exact_cast(Base* aBasePtr)
+{
+	return KCL::RTTI::ExactCast<Derived, Base>(aBasePtr);
+}
+
+template<typename Derived, typename Iterator>
+KCL_FORCEINLINE size_t kcl_dynamic_cast_batch(Iterator aBegin, Iterator aEnd, Derived* outPtrs)
+{
+	return KCL::RTTI::DynamicCastBatch<Derived>(aBegin, aEnd, outPtrs);
+}
+
 // Common declaration
 #define KCL_RTTI_TYPEINFO(TYPE)                                                                                                            \
 	template<>                                                                                                                             \
 	struct GetTypeInfo<TYPE>                                                                                                               \
 	{                                                                                                                                      \
-		static const KCL::RTTI::TypeInfo* Get()                                                                                            \
-		{                                                                                                                                  \
-			static TypeInfoImpl<TYPE> ourInstance = {{#TYPE}, TypeData<TYPE>()};                                                           \
-			return &ourInstance.myInfo;                                                                                                    \
-		}                                                                                                                                  \
+		static constexpr const char ourName[] = KCL_TOSTRING(TYPE);                                                                        \
+		static constexpr typeId_t ourTypeId = HashTypeName(ourName);                                                                       \
+                                                                                                                                           \
+		static constexpr const KCL::RTTI::TypeInfo* Get() { return &TypeInfoImpl<TYPE>::ourInfo; }                                         \
 	};
 
 // Use for all types, must include all directly inherited types in the macro
@@ -342,12 +665,12 @@ KCL_FORCEINLINE Derived kcl_dynamic_cast(Base* aBasePtr)
                                                                                                                                            \
 	intptr_t KCL_RTTI_DynamicCast(KCL::RTTI::typeId_t aOtherTypeId) const override                                                         \
 	{                                                                                                                                      \
-		typedef std::remove_pointer<decltype(this)>::type ObjectType;                                                                      \
+		typedef std::remove_pointer_t<decltype(this)> ObjectType;                                                                          \
 		return KCL::RTTI::template GetTypeInfo<ObjectType>()->CastTo((intptr_t)this, aOtherTypeId);                                        \
 	}                                                                                                                                      \
 	const KCL::RTTI::TypeInfo* KCL_RTTI_GetTypeInfo() const override                                                                       \
 	{                                                                                                                                      \
-		typedef std::remove_pointer<decltype(this)>::type ObjectType;                                                                      \
+		typedef std::remove_pointer_t<decltype(this)> ObjectType;                                                                          \
 		return KCL::RTTI::template GetTypeInfo<ObjectType>();                                                                              \
 	}                                                                                                                                      \
 	const char* KCL_RTTI_GetTypeName() const override                                                                                      \
@@ -356,6 +679,6 @@ KCL_FORCEINLINE Derived kcl_dynamic_cast(Base* aBasePtr)
 	}                                                                                                                                      \
 	KCL::RTTI::typeId_t KCL_RTTI_GetTypeId() const override                                                                                \
 	{                                                                                                                                      \
-		typedef std::remove_pointer<decltype(this)>::type ObjectType;                                                                      \
+		typedef std::remove_pointer_t<decltype(this)> ObjectType;                                                                          \
 		return KCL::RTTI::template GetTypeId<ObjectType>();                                                                                \
 	}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Hashing utilities
+
+namespace KCL
+{
+// MurmurHash64A, as used by GNU libstdc++ for std::hash<std::string>, reading the data in little endian order so that
+// the result doesn't depend on the platform. Gives the same values as vrc's util::calc_hash64, so that both libraries
+// give a class the same type id.
+constexpr uint64_t Hash64(const char* someData, size_t aSize)
+{
+	constexpr uint64_t seed = 0xc70f6907;
+	constexpr uint64_t mul = 0xc6a4a7935bd1e995ULL;
+	constexpr auto ShiftMix = [](uint64_t aValue) { return aValue ^ (aValue >> 47); };
+	const char* p8 = someData;
+	uint64_t hash = seed ^ ((uint64_t)aSize * mul);
+	for (const char* end8 = someData + (aSize & ~(size_t)7); p8 != end8; p8 += 8)
+	{
+		uint64_t value = 0;
+		for (const char* p = p8 + 8; p != p8; --p)
+			value = (value << 8) + (uint8_t)*(p - 1);
+		hash = (hash ^ ShiftMix(value * mul) * mul) * mul;
+	}
+	if (aSize & 7)
+	{
+		uint64_t value = 0;
+		for (const char* p = someData + aSize; p != p8; --p)
+			value = (value << 8) + (uint8_t)*(p - 1);
+		hash = (hash ^ value) * mul;
+	}
+	return ShiftMix(ShiftMix(hash) * mul);
+}
+} // namespace KCL
@@ -0,0 +1,185 @@
+/*
+ * Measures what the RTTI schemes cost at build time.
+ *
+ * Usage: build_benchmark GENERATOR WORK_DIR [--csv FILE] [COMPILER_FLAG...] TYPES:DEPTH:FANOUT:MI_PERCENT...
+ *
+ * For every hierarchy shape and every scheme (C++ RTTI with dynamic_cast, vrc, KCL), has GENERATOR write a program
+ * that defines the hierarchy and casts to each of its classes once, then compiles and links it with the compiler in
+ * the CXX environment variable (c++ if unset) and COMPILER_FLAGs. vrc and KCL programs are built with -fno-rtti too,
+ * since they don't need C++ RTTI. Reports the wall-clock compile time, the peak memory of the compiler, and the size
+ * of .text, .rodata, .data.rel.ro and of all vtables (the _ZTV symbols) of the program.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <elf.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Scheme {
+    const char* name;
+    bool no_rtti;
+};
+
+const Scheme SCHEMES[] = { { "std", false }, { "vrc", true }, { "kcl", true } };
+
+struct Sizes {
+    long long text = -1;
+    long long rodata = -1;
+    long long data_rel_ro = -1;
+    long long vtables = -1;
+};
+
+// Runs `args` and waits for it; returns false if it could not run or failed. `max_rss_kb` is the peak resident set
+// of the process.
+bool execute(const std::vector<std::string>& args, double& seconds, long& max_rss_kb)
+{
+    std::vector<char*> argv;
+    for (auto& arg: args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    auto begin = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        perror(argv[0]);
+        _exit(127);
+    }
+    int status = 0;
+    rusage usage{};
+    if (wait4(pid, &status, 0, &usage) != pid) return false;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    max_rss_kb = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Section and vtable sizes of a 64-bit ELF file; the sizes it can't find stay -1
+Sizes elf_sizes(const std::string& path)
+{
+    Sizes sizes;
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < sizeof(Elf64_Ehdr) || std::memcmp(file.data(), ELFMAG, SELFMAG) != 0
+        || file[EI_CLASS] != ELFCLASS64) {
+        return sizes;
+    }
+
+    auto header = reinterpret_cast<const Elf64_Ehdr*>(file.data());
+    if (header->e_shoff + size_t(header->e_shnum) * sizeof(Elf64_Shdr) > file.size()
+        || header->e_shstrndx >= header->e_shnum) {
+        return sizes;
+    }
+    auto sections = reinterpret_cast<const Elf64_Shdr*>(file.data() + header->e_shoff);
+    const char* names = file.data() + sections[header->e_shstrndx].sh_offset;
+
+    for (unsigned i = 0; i < header->e_shnum; ++i) {
+        const Elf64_Shdr& section = sections[i];
+        const char* name = names + section.sh_name;
+        if (std::strcmp(name, ".text") == 0) sizes.text = section.sh_size;
+        else if (std::strcmp(name, ".rodata") == 0) sizes.rodata = section.sh_size;
+        else if (std::strcmp(name, ".data.rel.ro") == 0) sizes.data_rel_ro = section.sh_size;
+        else if (section.sh_type == SHT_SYMTAB && section.sh_link < header->e_shnum) {
+            auto symbols = reinterpret_cast<const Elf64_Sym*>(file.data() + section.sh_offset);
+            const char* strings = file.data() + sections[section.sh_link].sh_offset;
+            sizes.vtables = 0;
+            for (size_t j = 0; j < section.sh_size / sizeof(Elf64_Sym); ++j) {
+                if (std::strncmp(strings + symbols[j].st_name, "_ZTV", 4) == 0) sizes.vtables += symbols[j].st_size;
+            }
+        }
+    }
+    return sizes;
+}
+
+// Kilobytes, or n/a
+std::string kb(long long bytes)
+{
+    if (bytes < 0) return "n/a";
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f", bytes / 1024.0);
+    return buffer;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s GENERATOR WORK_DIR [--csv FILE] [COMPILER_FLAG...] TYPES:DEPTH:FANOUT:MI_PERCENT...\n",
+                argv[0]);
+        return 2;
+    }
+    const std::string generator = argv[1];
+    const std::string work_dir = argv[2];
+    const char* compiler = std::getenv("CXX");
+    const char* csv_path = nullptr;
+    std::vector<std::string> flags;
+    std::vector<std::string> shapes;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_path = argv[++i];
+        else if (argv[i][0] == '-') flags.push_back(argv[i]);
+        else shapes.push_back(argv[i]);
+    }
+
+    FILE* csv = nullptr;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) {
+            fprintf(stderr, "Can't write %s\n", csv_path);
+            return 2;
+        }
+        fprintf(csv, "hierarchy,scheme,compile_s,peak_rss_kb,text_bytes,rodata_bytes,data_rel_ro_bytes,vtable_bytes\n");
+    }
+
+    printf("Compiler: %s", compiler ? compiler : "c++");
+    for (auto& flag: flags) printf(" %s", flag.c_str());
+    printf("\n\n```\n");
+    printf("%-20s %-6s %10s %10s %10s %10s %15s %10s\n", "hierarchy", "scheme", "compile s", "peak MB", ".text KB",
+           ".rodata KB", ".data.rel.ro KB", "vtable KB");
+
+    int failures = 0;
+    for (auto& shape: shapes) {
+        for (const Scheme& scheme: SCHEMES) {
+            std::string name = shape;
+            for (char& c: name) if (c == ':') c = '_';
+            const std::string base = work_dir + "/" + scheme.name + "_" + name;
+            double seconds = 0;
+            long rss_kb = 0;
+            if (!execute({ generator, "--scheme", scheme.name, base + ".cpp", shape }, seconds, rss_kb)) {
+                fprintf(stderr, "Can't generate %s\n", (base + ".cpp").c_str());
+                ++failures;
+                continue;
+            }
+
+            std::vector<std::string> command = { compiler ? compiler : "c++" };
+            command.insert(command.end(), flags.begin(), flags.end());
+            if (scheme.no_rtti) command.push_back("-fno-rtti");
+            command.insert(command.end(), { base + ".cpp", "-o", base });
+            if (!execute(command, seconds, rss_kb)) {
+                fprintf(stderr, "Can't compile %s\n", (base + ".cpp").c_str());
+                ++failures;
+                continue;
+            }
+
+            Sizes sizes = elf_sizes(base);
+            printf("%-20s %-6s %10.2f %10.1f %10s %10s %15s %10s\n", shape.c_str(), scheme.name, seconds,
+                   rss_kb / 1024.0, kb(sizes.text).c_str(), kb(sizes.rodata).c_str(), kb(sizes.data_rel_ro).c_str(),
+                   kb(sizes.vtables).c_str());
+            fflush(stdout);
+            if (csv) {
+                fprintf(csv, "%s,%s,%.3f,%ld,%lld,%lld,%lld,%lld\n", shape.c_str(), scheme.name, seconds, rss_kb,
+                        sizes.text, sizes.rodata, sizes.data_rel_ro, sizes.vtables);
+            }
+        }
+    }
+    printf("```\n");
+
+    if (csv) fclose(csv);
+    return failures ? 1 : 0;
+}
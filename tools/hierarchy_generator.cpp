@@ -0,0 +1,252 @@
+/*
+ * Generates synthetic class hierarchies for dynamic_cast_benchmark.
+ *
+ * Usage: hierarchy_generator OUTPUT TYPES:DEPTH:FANOUT:MI_PERCENT...
+ *        hierarchy_generator --scheme std|vrc|kcl OUTPUT TYPES:DEPTH:FANOUT:MI_PERCENT
+ *
+ * Every TYPES:DEPTH:FANOUT:MI_PERCENT argument becomes a namespace with TYPES classes derived from the benchmark's
+ * class A, registered with both KCL and vrc. The classes form a random tree with at most FANOUT children per class,
+ * exactly DEPTH levels deep: a spine of one class per level is created first, the other classes are attached to
+ * random classes with room left. MI_PERCENT percent of the classes also derive from one of a few interface classes
+ * that no ancestor derives from yet, the way the cross hierarchy does. The output is deterministic.
+ *
+ * With --scheme the output is instead a self-contained program with its own class A, using only one RTTI scheme
+ * (C++ RTTI, vrc or KCL) and casting to every class once, for build_benchmark to compile.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+enum class Scheme { benchmark, std_rtti, vrc, kcl };
+
+struct Config {
+    unsigned types;
+    unsigned depth;
+    unsigned fanout;
+    unsigned mi_percent;
+};
+
+struct Node {
+    int parent;
+    unsigned depth;
+    unsigned children;
+    int iface;
+    std::vector<bool> ifaces; // interfaces this class derives from, directly or not
+};
+
+bool parse_config(const char* arg, Config& config)
+{
+    return sscanf(arg, "%u:%u:%u:%u", &config.types, &config.depth, &config.fanout, &config.mi_percent) == 4
+        && config.types > 0 && config.depth > 0 && config.fanout > 0 && config.mi_percent <= 100;
+}
+
+std::vector<Node> generate_tree(const Config& config, unsigned iface_count, std::mt19937& rng)
+{
+    std::vector<Node> nodes;
+    auto add = [&](int parent) {
+        Node node{ parent, 0, 0, -1, std::vector<bool>(iface_count) };
+        if (parent >= 0) {
+            Node& p = nodes[parent];
+            node.depth = p.depth + 1;
+            node.ifaces = p.ifaces;
+            ++p.children;
+            std::vector<unsigned> free;
+            for (unsigned i = 0; i < iface_count; ++i) if (!node.ifaces[i]) free.push_back(i);
+            if (!free.empty() && rng() % 100 < config.mi_percent) {
+                node.iface = int(free[rng() % free.size()]);
+                node.ifaces[node.iface] = true;
+            }
+        }
+        nodes.push_back(node);
+    };
+
+    add(-1);
+    while (nodes.size() < config.types && nodes.size() < config.depth) add(int(nodes.size()) - 1);
+    while (nodes.size() < config.types) {
+        std::vector<int> candidates;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].depth + 1 < config.depth && nodes[i].children < config.fanout) candidates.push_back(int(i));
+        }
+        if (candidates.empty()) break;
+        add(candidates[rng() % candidates.size()]);
+    }
+    return nodes;
+}
+
+// Base classes of a class with no bases
+std::string root_bases(Scheme scheme)
+{
+    switch (scheme) {
+        case Scheme::benchmark: return " : KCL::RTTI::Base, vrc::RttiBase";
+        case Scheme::vrc:       return " : vrc::RttiBase";
+        case Scheme::kcl:       return " : KCL::RTTI::Base";
+        case Scheme::std_rtti:  return "";
+    }
+    return "";
+}
+
+// Writes the definition of class `name`, given its bases the way vrc lists them (secondary ones as vrc::AsIface<I>)
+void write_class(FILE* out, Scheme scheme, const std::string& name, const std::string& vrc_bases, const char* fields)
+{
+    std::string bases = vrc_bases;
+    if (size_t iface = bases.find("vrc::AsIface<"); iface != std::string::npos) {
+        bases.erase(iface, 13);
+        bases.pop_back();
+    }
+    std::string line = "struct " + name + (bases.empty() ? root_bases(scheme) : " : " + bases) + " { ";
+    if (scheme == Scheme::benchmark || scheme == Scheme::kcl) line += "KCL_RTTI_IMPL(); ";
+    if (scheme == Scheme::benchmark || scheme == Scheme::vrc) line += "VRC_IMPLEMENT_DYNAMIC_CAST(" + vrc_bases + "); ";
+    if (scheme == Scheme::std_rtti && bases.empty()) line += "virtual ~" + name + "() = default; ";
+    fprintf(out, "%s%s };\n", line.c_str(), fields);
+}
+
+void write_hierarchy(FILE* out, const Config& config, Scheme scheme, std::string& list)
+{
+    const std::string ns = "synthetic_" + std::to_string(config.types) + "_" + std::to_string(config.depth) + "_"
+        + std::to_string(config.fanout) + "_" + std::to_string(config.mi_percent);
+    const unsigned iface_count = config.mi_percent ? std::max(1u, config.types / 32) : 0;
+    std::mt19937 rng(config.types * 1000003u + config.depth * 10007u + config.fanout * 101u + config.mi_percent);
+    const std::vector<Node> nodes = generate_tree(config, iface_count, rng);
+    const bool kcl = scheme == Scheme::benchmark || scheme == Scheme::kcl;
+    const bool vrc = scheme == Scheme::benchmark || scheme == Scheme::vrc;
+
+    auto bases = [&](const Node& n) {
+        std::string base = n.parent < 0 ? "A" : "C" + std::to_string(n.parent);
+        if (n.iface >= 0) base += ", vrc::AsIface<I" + std::to_string(n.iface) + ">";
+        return base;
+    };
+    auto kcl_bases = [&](const Node& n) {
+        std::string base = n.parent < 0 ? "A" : ns + "::C" + std::to_string(n.parent);
+        if (n.iface >= 0) base += ", " + ns + "::I" + std::to_string(n.iface);
+        return base;
+    };
+
+    fprintf(out, "// %zu types, depth %u, fan-out %u, %u%% multiple inheritance\n", nodes.size(), config.depth,
+            config.fanout, config.mi_percent);
+    fprintf(out, "namespace %s {\n", ns.c_str());
+    for (unsigned i = 0; i < iface_count; ++i) {
+        fprintf(out, "    ");
+        write_class(out, scheme, "I" + std::to_string(i), "", "uint64_t v{1};");
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        fprintf(out, "    ");
+        write_class(out, scheme, "C" + std::to_string(i), bases(nodes[i]), "uint64_t v{1};");
+    }
+    fprintf(out, "}\n");
+
+    if (kcl) {
+        for (unsigned i = 0; i < iface_count; ++i) fprintf(out, "KCL_RTTI_REGISTER(%s::I%u);\n", ns.c_str(), i);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            fprintf(out, "KCL_RTTI_REGISTER(%s::C%zu, %s);\n", ns.c_str(), i, kcl_bases(nodes[i]).c_str());
+        }
+    }
+    if (vrc) {
+        for (unsigned i = 0; i < iface_count; ++i) fprintf(out, "VRC_DECLARE_CLASS_NAME(%s::I%u);\n", ns.c_str(), i);
+        for (size_t i = 0; i < nodes.size(); ++i) fprintf(out, "VRC_DECLARE_CLASS_NAME(%s::C%zu);\n", ns.c_str(), i);
+    }
+
+    if (scheme != Scheme::benchmark) {
+        const char* cast = scheme == Scheme::vrc ? "vrc::dynamicCast<T>(p)"
+                         : scheme == Scheme::kcl ? "kcl_dynamic_cast<T*>(p)"
+                         : "dynamic_cast<T*>(p)";
+        fprintf(out, "\ntemplate<typename T>\n");
+        fprintf(out, "uint64_t get(A* p) { auto* q = %s; return q ? q->v : 0; }\n\n", cast);
+        fprintf(out, "A* make(unsigned index)\n{\n    using namespace %s;\n    switch (index) {\n", ns.c_str());
+        for (size_t i = 1; i < nodes.size(); ++i) fprintf(out, "        case %zu: return new C%zu;\n", i, i);
+        fprintf(out, "        default: return new C0;\n    }\n}\n\n");
+        fprintf(out, "uint64_t (*const getters[])(A*) = {\n");
+        for (size_t i = 0; i < nodes.size(); ++i) fprintf(out, "    get<%s::C%zu>,\n", ns.c_str(), i);
+        fprintf(out, "};\n\n");
+        fprintf(out, "int main(int argc, char**)\n{\n    A* p = make(unsigned(argc));\n    uint64_t s = 0;\n");
+        fprintf(out, "    for (auto get: getters) s += get(p);\n    delete p;\n    return int(s);\n}\n");
+        return;
+    }
+
+    fprintf(out, "namespace %s {\n", ns.c_str());
+    fprintf(out, "    struct Hierarchy {\n");
+    fprintf(out, "        static constexpr const char* NAME = \"%s\";\n", ns.c_str());
+    fprintf(out, "        static constexpr unsigned TYPES = %zu;\n", nodes.size());
+    fprintf(out, "        static constexpr unsigned DEPTH = %u;\n", config.depth);
+    fprintf(out, "        static constexpr unsigned FANOUT = %u;\n", config.fanout);
+    fprintf(out, "        static constexpr unsigned MI_PERCENT = %u;\n\n", config.mi_percent);
+    fprintf(out, "        // Returns make.operator()<C>() for class C<index>, index < TYPES\n");
+    fprintf(out, "        template<typename Make>\n");
+    fprintf(out, "        static auto make(unsigned index, Make&& make) {\n");
+    fprintf(out, "            switch (index) {\n");
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        fprintf(out, "                case %zu: return make.template operator()<C%zu>();\n", i, i);
+    }
+    fprintf(out, "                default: return make.template operator()<C0>();\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        // Calls visit.operator()<T, &T::v>(label) for the class at every level of the spine, and an interface\n");
+    fprintf(out, "        template<typename Visit>\n");
+    fprintf(out, "        static void for_each_target(Visit&& visit) {\n");
+    for (unsigned d = 0; d < config.depth && d < nodes.size(); ++d) {
+        fprintf(out, "            visit.template operator()<C%u, &C%u::v>(\"d%u\");\n", d, d, d);
+    }
+    if (iface_count) fprintf(out, "            visit.template operator()<I0, &I0::v>(\"I0\");\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    };\n");
+    fprintf(out, "}\n\n");
+
+    list += (list.empty() ? "" : ", ") + ns + "::Hierarchy";
+}
+
+int main(int argc, char** argv)
+{
+    Scheme scheme = Scheme::benchmark;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--scheme") == 0) {
+        if (strcmp(argv[2], "std") == 0) scheme = Scheme::std_rtti;
+        else if (strcmp(argv[2], "vrc") == 0) scheme = Scheme::vrc;
+        else if (strcmp(argv[2], "kcl") == 0) scheme = Scheme::kcl;
+        else first = argc;
+        first += 2;
+    }
+    std::vector<Config> configs;
+    for (int i = first + 1; i < argc; ++i) {
+        Config config;
+        if (!parse_config(argv[i], config)) {
+            fprintf(stderr, "Invalid hierarchy '%s', expected TYPES:DEPTH:FANOUT:MI_PERCENT\n", argv[i]);
+            return 1;
+        }
+        configs.push_back(config);
+    }
+    if (first >= argc || (scheme != Scheme::benchmark && configs.size() != 1)) {
+        fprintf(stderr, "Usage: %s OUTPUT TYPES:DEPTH:FANOUT:MI_PERCENT...\n"
+                        "       %s --scheme std|vrc|kcl OUTPUT TYPES:DEPTH:FANOUT:MI_PERCENT\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    FILE* out = fopen(argv[first], "w");
+    if (!out) {
+        fprintf(stderr, "Can't write %s\n", argv[first]);
+        return 1;
+    }
+    fprintf(out, "// Generated by hierarchy_generator, do not edit.\n");
+    if (scheme == Scheme::benchmark) {
+        fprintf(out, "// Include after the definition of class A.\n\n");
+        fprintf(out, "#pragma once\n\n");
+        fprintf(out, "#include <tuple>\n\n");
+        std::string list;
+        for (const Config& config: configs) write_hierarchy(out, config, scheme, list);
+        fprintf(out, "using SyntheticHierarchies = std::tuple<%s>;\n", list.c_str());
+    } else {
+        if (scheme == Scheme::vrc) fprintf(out, "#include \"vrc/rtti_base.h\"\n");
+        if (scheme == Scheme::kcl) fprintf(out, "#include \"KCL/KCL_RTTI.h\"\n");
+        fprintf(out, "\n#include <cstdint>\n\n");
+        write_class(out, scheme, "A", "", "uint64_t a{1}; uint64_t z{0};");
+        if (scheme == Scheme::kcl) fprintf(out, "KCL_RTTI_REGISTER(A);\n");
+        if (scheme == Scheme::vrc) fprintf(out, "VRC_DECLARE_CLASS_NAME(A);\n");
+        fprintf(out, "\n");
+        std::string list;
+        write_hierarchy(out, configs[0], scheme, list);
+    }
+    return fclose(out) == 0 ? 0 : 1;
+}
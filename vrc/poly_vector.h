@@ -0,0 +1,94 @@
+#pragma once
+
+#include "rtti_base.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace vrc {
+
+// Container of objects derived from `Base`, storing each concrete class contiguously in its own segment. Iterating
+// over the objects of kind `Ty2` casts the first object of every segment only, and skips or walks the segment as a
+// whole. Objects are moved when their segment grows, so pointers to them are not stable.
+template<typename Base>
+class PolyVector {
+ private:
+    class Segment {
+     public:
+        explicit Segment(const TypeInfo& type, std::size_t stride) : type_(&type), stride_(stride) {}
+        virtual ~Segment() = default;
+
+        const TypeInfo& type() const { return *type_; }
+        std::size_t stride() const { return stride_; }
+
+        virtual std::size_t size() const = 0;
+        virtual std::byte* data() = 0;
+        virtual Base* front() = 0;
+
+     private:
+        const TypeInfo* type_;
+        std::size_t stride_;
+    };
+
+    template<typename Ty>
+    class TypedSegment final : public Segment {
+     public:
+        TypedSegment() : Segment(typeInfo<Ty>(), sizeof(Ty)) {}
+
+        std::size_t size() const override { return items.size(); }
+        std::byte* data() override { return reinterpret_cast<std::byte*>(items.data()); }
+        Base* front() override { return &items.front(); }
+
+        std::vector<Ty> items;
+    };
+
+    std::vector<std::unique_ptr<Segment>> segments_;
+    std::size_t size_ = 0;
+
+    // Segments are told apart by the address of their class info: with narrow ids two classes may share an id
+    template<typename Ty>
+    std::vector<Ty>& segment() {
+        const TypeInfo& type = typeInfo<Ty>();
+        for (auto& segment : segments_) {
+            if (&segment->type() == &type) { return static_cast<TypedSegment<Ty>&>(*segment).items; }
+        }
+        return static_cast<TypedSegment<Ty>&>(*segments_.emplace_back(std::make_unique<TypedSegment<Ty>>())).items;
+    }
+
+ public:
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t segmentCount() const { return segments_.size(); }
+
+    template<typename Ty>
+    void reserve(std::size_t count) {
+        segment<Ty>().reserve(count);
+    }
+
+    template<typename Ty, typename... Args>
+    Ty& emplaceBack(Args&&... args) {
+        static_assert(std::is_convertible_v<Ty*, Base*>, "type must derive from the base");
+        Ty& item = segment<Ty>().emplace_back(std::forward<Args>(args)...);
+        ++size_;
+        return item;
+    }
+
+    // Calls `func(Ty2&)` for every object of kind `Ty2`, segment by segment
+    template<typename Ty2, typename Func>
+    void forEach(Func&& func) {
+        for (auto& segment : segments_) {
+            const std::size_t count = segment->size();
+            if (count == 0) { continue; }
+            std::byte* first = segment->data();
+            Ty2* target = dynamicCast<Ty2>(segment->front());
+            if (!target) { continue; }
+            const std::ptrdiff_t offset = reinterpret_cast<std::byte*>(target) - first;
+            const std::size_t stride = segment->stride();
+            for (std::size_t i = 0; i < count; ++i) { func(*reinterpret_cast<Ty2*>(first + i * stride + offset)); }
+        }
+    }
+};
+
+}  // namespace vrc
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "rtti_base.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace vrc {
+
+// Reference-counted pointer to an object derived from `RttiBase`, which holds the count itself: no control block is
+// allocated, and the count shares a cache line with the vptr that casts read anyway. Besides the pointer, a `Ref`
+// keeps the subobject holding the count, so that copies and casts never need a virtual call. When the last `Ref`
+// goes away, the object is deleted through its virtual destructor.
+template<typename Ty>
+class Ref {
+ private:
+    template<typename>
+    friend class Ref;
+
+    Ty* ptr_ = nullptr;
+    const RttiBase* owner_ = nullptr;
+
+    static void retain(const RttiBase* owner) {
+        if (owner) { owner->refs_.fetch_add(1, std::memory_order_relaxed); }
+    }
+
+    static void release(const RttiBase* owner) {
+        if (owner && owner->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) { delete owner; }
+    }
+
+ public:
+    constexpr Ref() = default;
+    constexpr Ref(std::nullptr_t) {}
+    explicit Ref(Ty* ptr) : ptr_(ptr), owner_(ptr ? &ptr->refCountOwner() : nullptr) { retain(owner_); }
+
+    Ref(const Ref& other) : ptr_(other.ptr_), owner_(other.owner_) { retain(owner_); }
+    Ref(Ref&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr)), owner_(std::exchange(other.owner_, nullptr)) {}
+
+    template<typename Ty2, typename = std::enable_if_t<std::is_convertible_v<Ty2*, Ty*>>>
+    Ref(const Ref<Ty2>& other) : ptr_(other.ptr_), owner_(other.owner_) {
+        retain(owner_);
+    }
+    template<typename Ty2, typename = std::enable_if_t<std::is_convertible_v<Ty2*, Ty*>>>
+    Ref(Ref<Ty2>&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr)), owner_(std::exchange(other.owner_, nullptr)) {}
+
+    // Aliasing constructors: point to `ptr`, a subobject of the object `other` refers to, and share its count
+    template<typename Ty2>
+    Ref(const Ref<Ty2>& other, Ty* ptr) : ptr_(ptr), owner_(other.owner_) {
+        retain(owner_);
+    }
+    template<typename Ty2>
+    Ref(Ref<Ty2>&& other, Ty* ptr) noexcept : ptr_(ptr), owner_(std::exchange(other.owner_, nullptr)) {
+        other.ptr_ = nullptr;
+    }
+
+    ~Ref() { release(owner_); }
+
+    Ref& operator=(Ref other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(Ref& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        std::swap(owner_, other.owner_);
+    }
+
+    void reset() { Ref().swap(*this); }
+
+    // Gives up the reference without releasing it, so that the object is never deleted through a `Ref`
+    Ty* detach() {
+        owner_ = nullptr;
+        return std::exchange(ptr_, nullptr);
+    }
+
+    Ty* get() const { return ptr_; }
+    Ty& operator*() const { return *ptr_; }
+    Ty* operator->() const { return ptr_; }
+    explicit operator bool() const { return ptr_ != nullptr; }
+
+    std::uint32_t useCount() const { return owner_ ? owner_->refs_.load(std::memory_order_relaxed) : 0; }
+
+    template<typename Ty2>
+    bool operator==(const Ref<Ty2>& other) const {
+        return ptr_ == other.get();
+    }
+    bool operator==(std::nullptr_t) const { return ptr_ == nullptr; }
+};
+
+template<typename Ty, typename... Args>
+Ref<Ty> makeRef(Args&&... args) {
+    return Ref<Ty>(new Ty(std::forward<Args>(args)...));
+}
+
+template<typename Ty2, typename Ty, typename = std::enable_if_t<std::is_convertible_v<Ty*, Ty2*>>>
+Ref<Ty2> upCast(const Ref<Ty>& ptr) {
+    return Ref<Ty2>{ptr};
+}
+
+template<typename Ty2, typename Ty, typename = std::enable_if_t<std::is_convertible_v<Ty*, Ty2*>>>
+Ref<Ty2> upCast(Ref<Ty>&& ptr) {
+    return Ref<Ty2>{std::move(ptr)};
+}
+
+template<typename Ty2, typename Ty>
+Ref<Ty2> dynamicCast(const Ref<Ty>& ptr) {
+    if (auto* result = dynamicCast<Ty2>(ptr.get())) { return {ptr, result}; }
+    return nullptr;
+}
+
+// Leaves the count untouched: the reference moves from `ptr` to the result, or stays in `ptr` if the cast fails
+template<typename Ty2, typename Ty>
+Ref<Ty2> dynamicCast(Ref<Ty>&& ptr) {
+    if (auto* result = dynamicCast<Ty2>(ptr.get())) { return {std::move(ptr), result}; }
+    return nullptr;
+}
+
+template<typename Ty2, typename Ty>
+bool isKindOf(const Ref<Ty>& ptr) {
+    return isKindOf<Ty2>(ptr.get());
+}
+
+}  // namespace vrc
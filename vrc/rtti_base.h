@@ -1,8 +1,17 @@
 #pragma once
 
 #include "type_id.h"
+#include "type_info.h"
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 #if !defined(FORCE_INLINE)
@@ -16,6 +25,7 @@
 #endif  // !defined(FORCE_INLINE)
 
 #define VRC_IMPLEMENT_DYNAMIC_CAST(...) \
+    using RttiBases = vrc::BaseList<__VA_ARGS__>; \
     FORCE_INLINE const void* dynamicCast(util::type_id id) const override { \
         using Ty = std::remove_const_t<std::remove_pointer_t<decltype(this)>>; \
         return vrc::detail::dynamicCastImpl<Ty, vrc::AsIface<Ty>, ##__VA_ARGS__>{}(this, id); \
@@ -23,14 +33,49 @@
     FORCE_INLINE void* dynamicCast(util::type_id id) { \
         return const_cast<void*>(std::as_const(*this).dynamicCast(id)); \
     } \
+    FORCE_INLINE const void* flatDynamicCast(util::type_id id) const override { \
+        return vrc::detail::findInCastTable(this, id); \
+    } \
+    FORCE_INLINE void* flatDynamicCast(util::type_id id) { \
+        return const_cast<void*>(std::as_const(*this).flatDynamicCast(id)); \
+    } \
+    FORCE_INLINE const vrc::TypeInfo& typeInfo() const override { \
+        using Ty = std::remove_const_t<std::remove_pointer_t<decltype(this)>>; \
+        return vrc::detail::getTypeInfo<Ty>(); \
+    } \
+    FORCE_INLINE const vrc::RttiBase& refCountOwner() const override { \
+        using Ty = std::remove_const_t<std::remove_pointer_t<decltype(this)>>; \
+        return vrc::detail::primaryRttiBase<Ty>(*this); \
+    } \
     static_assert(true)
 
 namespace vrc {
 
+template<typename Ty>
+class Ref;
+
+// The reference count used by `Ref` sits right after the vptr; copies of an object start unreferenced
 struct RttiBase {
+    RttiBase() = default;
+    RttiBase(const RttiBase&) noexcept {}
+    RttiBase& operator=(const RttiBase&) noexcept { return *this; }
     virtual ~RttiBase() = default;
     virtual const void* dynamicCast(util::type_id id) const = 0;
     FORCE_INLINE void* dynamicCast(util::type_id id) { return const_cast<void*>(std::as_const(*this).dynamicCast(id)); }
+    virtual const void* flatDynamicCast(util::type_id id) const = 0;
+    FORCE_INLINE void* flatDynamicCast(util::type_id id) {
+        return const_cast<void*>(std::as_const(*this).flatDynamicCast(id));
+    }
+    virtual const TypeInfo& typeInfo() const = 0;
+    // The `RttiBase` subobject holding the reference count of the whole object: the one reached through primary
+    // bases, since a class with several bases has one `RttiBase` per base
+    virtual const RttiBase& refCountOwner() const = 0;
+
+ private:
+    template<typename>
+    friend class Ref;
+
+    mutable std::atomic<std::uint32_t> refs_{0};
 };
 
 template<typename Ty>
@@ -38,6 +83,89 @@ struct AsIface {
     using type = Ty;
 };
 
+template<typename... Bases>
+struct BaseList {};
+
+namespace detail {
+template<typename Base>
+struct BaseType {
+    using type = Base;
+};
+template<typename Base>
+struct BaseType<AsIface<Base>> {
+    using type = Base;
+};
+
+template<typename Ty, typename = typename Ty::RttiBases>
+struct PrimaryRttiBase;
+
+template<typename Ty>
+const RttiBase& primaryRttiBase(const Ty& object);
+
+template<typename Ty>
+RttiBase* createObject() {
+    return const_cast<RttiBase*>(&primaryRttiBase(*new Ty()));
+}
+
+template<typename Ty>
+constexpr RttiBase* (*objectFactory())() {
+    if constexpr (!std::is_abstract_v<Ty> && std::is_default_constructible_v<Ty>) {
+        return &createObject<Ty>;
+    } else {
+        return nullptr;
+    }
+}
+
+template<typename Ty, typename = typename Ty::RttiBases>
+struct TypeInfoHolder;
+template<typename Ty, typename... Bases>
+struct TypeInfoHolder<Ty, BaseList<Bases...>> {
+    static inline constinit TypeInfo* const bases[sizeof...(Bases) + 1] = {
+        &TypeInfoHolder<typename BaseType<Bases>::type>::info..., nullptr};
+    static inline constinit TypeInfo info{{util::class_name<Ty>::value.data(), util::class_name<Ty>::value.size()},
+                                          util::class_id<Ty>::value,
+                                          bases,
+                                          sizeof...(Bases),
+                                          objectFactory<Ty>()};
+    static inline const TypeRegistrar registrar{info};
+};
+
+template<typename Ty>
+struct PrimaryRttiBase<Ty, BaseList<>> {
+    static const RttiBase& get(const Ty& object) { return object; }
+};
+template<typename Ty, typename Base, typename... Tail>
+struct PrimaryRttiBase<Ty, BaseList<Base, Tail...>> {
+    using Primary = typename BaseType<Base>::type;
+    static const RttiBase& get(const Ty& object) { return PrimaryRttiBase<Primary>::get(object); }
+};
+
+template<typename Ty>
+const RttiBase& primaryRttiBase(const Ty& object) {
+    return PrimaryRttiBase<Ty>::get(object);
+}
+
+// Keeps `TypeInfoHolder` from being instantiated inside the class body, before the class name is declared
+template<typename Ty>
+const TypeInfo& getTypeInfo() {
+    static_cast<void>(&TypeInfoHolder<Ty>::registrar);
+    return TypeInfoHolder<Ty>::info;
+}
+
+template<typename Ty, typename Ty2>
+concept StaticDownCastable = requires(Ty* ptr) { static_cast<Ty2*>(ptr); };
+
+// False if the id of `Ty2` equals the id of another ancestor of `Ty`, so that a cast to `Ty2` could succeed on any
+// object of type `Ty`
+template<typename Ty2, typename Ty>
+constexpr bool distinctFromAncestors();
+}  // namespace detail
+
+template<typename Ty>
+const TypeInfo& typeInfo() {
+    return detail::getTypeInfo<std::remove_cv_t<Ty>>();
+}
+
 template<typename Ty2, typename Ty, typename = std::enable_if_t<std::is_convertible_v<Ty*, Ty2*>>>
 Ty2* upCast(Ty* ptr) {
     return ptr;
@@ -53,9 +181,24 @@ std::shared_ptr<Ty2> upCast(std::shared_ptr<Ty>&& ptr) {
     return std::shared_ptr<Ty2>{std::move(ptr)};
 }
 
+// Casts only if `Ty2` is the most-derived class of `*ptr`: compares type descriptors instead of searching ancestors
+template<typename Ty2, typename Ty>
+Ty2* exactCast(Ty* ptr) {
+    if (!ptr || &ptr->typeInfo() != &typeInfo<Ty2>()) { return nullptr; }
+    if constexpr (detail::StaticDownCastable<Ty, Ty2>) {
+        return static_cast<Ty2*>(ptr);
+    } else {
+        // Through the recursion rather than the flattened table, which is empty until dynamic initialization
+        return static_cast<Ty2*>(ptr->dynamicCast(util::type_traits<Ty2>::id()));
+    }
+}
+
+// Casts to final classes, here and below, go through `exactCast`
 template<typename Ty2, typename Ty>
 Ty2* dynamicCast(Ty* ptr) {
     if constexpr (std::is_convertible_v<Ty*, Ty2*>) { return ptr; }
+    if constexpr (std::is_final_v<Ty2>) { return exactCast<Ty2>(ptr); }
+    static_assert(detail::distinctFromAncestors<Ty2, Ty>(), "type id collision: use wider ids (VRC_TYPE_ID_BITS)");
     return ptr ? static_cast<Ty2*>(ptr->dynamicCast(util::type_traits<Ty2>::id())) : nullptr;
 }
 
@@ -71,9 +214,52 @@ std::shared_ptr<Ty2> dynamicCast(std::shared_ptr<Ty>&& ptr) {
     return nullptr;
 }
 
+// Same as `dynamicCast`, but looks the target up in the flattened ancestor table of the most-derived class
+template<typename Ty2, typename Ty>
+Ty2* flatDynamicCast(Ty* ptr) {
+    if constexpr (std::is_convertible_v<Ty*, Ty2*>) { return ptr; }
+    if constexpr (std::is_final_v<Ty2>) { return exactCast<Ty2>(ptr); }
+    static_assert(detail::distinctFromAncestors<Ty2, Ty>(), "type id collision: use wider ids (VRC_TYPE_ID_BITS)");
+    return ptr ? static_cast<Ty2*>(ptr->flatDynamicCast(util::type_traits<Ty2>::id())) : nullptr;
+}
+
+// Same as `dynamicCast`, but when `Ty2` is derived from `Ty` through primary bases only, tests the interval numbers
+// of the two classes and static-casts; other casts go through the flattened ancestor table
+template<typename Ty2, typename Ty>
+Ty2* intervalCast(Ty* ptr) {
+    if constexpr (std::is_convertible_v<Ty*, Ty2*>) {
+        return ptr;
+    } else if constexpr (detail::StaticDownCastable<Ty, Ty2>) {
+        const TypeInfo& target = typeInfo<Ty2>();
+        if (!target.isSecondaryBase() && !typeInfo<Ty>().isSecondaryBase()) {
+            return ptr && target.isPrimaryBaseOf(ptr->typeInfo()) ? static_cast<Ty2*>(ptr) : nullptr;
+        }
+    }
+    return flatDynamicCast<Ty2>(ptr);
+}
+
+// Same as `dynamicCast`, but tests the ancestor bitset of the object's class first, so that failing casts cost a
+// single AND; on success the pointer is static-cast, or adjusted through the flattened ancestor table
+template<typename Ty2, typename Ty>
+Ty2* bitsetCast(Ty* ptr) {
+    if constexpr (std::is_convertible_v<Ty*, Ty2*>) {
+        return ptr;
+    } else {
+        const TypeInfo& target = typeInfo<Ty2>();
+        if (!target.hasAncestorBit()) { return flatDynamicCast<Ty2>(ptr); }
+        if (!ptr || !target.isBaseOf(ptr->typeInfo())) { return nullptr; }
+        if constexpr (detail::StaticDownCastable<Ty, Ty2>) {
+            if (!typeInfo<Ty>().isSecondaryBase()) { return static_cast<Ty2*>(ptr); }
+        }
+        return flatDynamicCast<Ty2>(ptr);
+    }
+}
+
 template<typename Ty2, typename Ty>
 bool isKindOf(Ty* ptr) {
     if constexpr (std::is_convertible_v<Ty*, Ty2*>) { return true; }
+    if constexpr (std::is_final_v<Ty2>) { return exactCast<Ty2>(ptr) != nullptr; }
+    static_assert(detail::distinctFromAncestors<Ty2, Ty>(), "type id collision: use wider ids (VRC_TYPE_ID_BITS)");
     return ptr && ptr->dynamicCast(util::type_traits<Ty2>::id());
 }
 
@@ -82,6 +268,243 @@ bool isKindOf(const std::shared_ptr<Ty>& ptr) {
     return isKindOf<Ty2>(ptr.get());
 }
 
+namespace detail {
+template<typename Ty>
+const void* getVptr(const Ty* ptr) {
+    static_assert(std::is_polymorphic_v<Ty>, "type must be polymorphic");
+    return *reinterpret_cast<const void* const*>(ptr);
+}
+
+// Cast results remembered as the `this` adjustment from the source pointer, or `kFailedCast`
+inline constexpr std::ptrdiff_t kFailedCast = PTRDIFF_MIN;
+
+template<typename Ty2, typename Ty>
+std::ptrdiff_t castOffset(Ty* ptr, Ty2* result) {
+    return result ? reinterpret_cast<char*>(result) - reinterpret_cast<char*>(ptr) : kFailedCast;
+}
+
+template<typename Ty2, typename Ty>
+Ty2* applyCastOffset(Ty* ptr, std::ptrdiff_t offset) {
+    return offset != kFailedCast ? reinterpret_cast<Ty2*>(reinterpret_cast<char*>(ptr) + offset) : nullptr;
+}
+}  // namespace detail
+
+// Inline cache of `dynamicCast<Ty2>` results keyed on the vptr of the source object. The same vptr always means
+// the same most-derived type and the same subobject, so the `this` adjustment (or the failure) found by the first
+// cast can be reused. Slots are claimed once and never overwritten, so concurrent readers never see a torn entry;
+// when all slots are taken the remaining types go through the regular `dynamicCast`.
+template<typename Ty2, std::size_t Size = 4>
+class CastCache {
+ private:
+    std::atomic<const void*> vptrs_[Size]{};
+    std::ptrdiff_t offsets_[Size]{};
+    std::atomic<std::size_t> count_{0};
+
+    template<typename Ty>
+    Ty2* miss(Ty* ptr, const void* vptr) {
+        auto* result = static_cast<Ty2*>(ptr->dynamicCast(util::type_traits<Ty2>::id()));
+        std::size_t n = count_.load(std::memory_order_relaxed);
+        if (n < Size && count_.compare_exchange_strong(n, n + 1, std::memory_order_relaxed)) {
+            offsets_[n] = detail::castOffset(ptr, result);
+            vptrs_[n].store(vptr, std::memory_order_release);
+        }
+        return result;
+    }
+
+ public:
+    constexpr CastCache() = default;
+    CastCache(const CastCache&) = delete;
+    CastCache& operator=(const CastCache&) = delete;
+
+    template<typename Ty>
+    Ty2* cast(Ty* ptr) {
+        if constexpr (std::is_convertible_v<Ty*, Ty2*>) { return ptr; }
+        if (!ptr) { return nullptr; }
+        const void* vptr = detail::getVptr(ptr);
+        for (std::size_t i = 0; i < Size; ++i) {
+            if (vptrs_[i].load(std::memory_order_acquire) == vptr) {
+                return detail::applyCastOffset<Ty2>(ptr, offsets_[i]);
+            }
+        }
+        return miss(ptr, vptr);
+    }
+};
+
+// Same as `dynamicCast`, but goes through a `CastCache` of its own call site: `Site` defaults to the type of a lambda,
+// which is distinct at every call, so that casts elsewhere can't take the slots. Calls passing the same `Site` share
+// a cache; a loop that needs a cache per run-time context owns a `CastCache` instead.
+template<typename Ty2, typename Site = decltype([] {}), typename Ty>
+Ty2* cachedDynamicCast(Ty* ptr) {
+    static CastCache<Ty2> cache;
+    return cache.cast(ptr);
+}
+
+namespace detail {
+// Direct-mapped cache of `dynamicCast<Ty2>` results, private to one batch
+template<typename Ty2, std::size_t Size = 16>
+class BatchCastCache {
+ private:
+    struct Entry {
+        const void* vptr = nullptr;
+        std::ptrdiff_t offset = 0;
+    };
+
+    Entry entries_[Size];
+
+ public:
+    template<typename Ty>
+    Ty2* cast(Ty* ptr) {
+        if constexpr (std::is_convertible_v<Ty*, Ty2*>) { return ptr; }
+        if (!ptr) { return nullptr; }
+        const void* vptr = getVptr(ptr);
+        Entry& entry = entries_[reinterpret_cast<std::uintptr_t>(vptr) / sizeof(void*) % Size];
+        if (entry.vptr != vptr) {
+            entry = {vptr, castOffset(ptr, static_cast<Ty2*>(ptr->dynamicCast(util::type_traits<Ty2>::id())))};
+        }
+        return applyCastOffset<Ty2>(ptr, entry.offset);
+    }
+};
+}  // namespace detail
+
+// Casts every pointer of `ptrs` (raw or smart) to `Ty2`, resolving each distinct vptr once per batch. Writes the
+// successful casts to `out` in order, and returns their count.
+template<typename Ty2, typename Range>
+std::size_t dynamicCastBatch(const Range& ptrs, Ty2** out) {
+    detail::BatchCastCache<Ty2> cache;
+    std::size_t count = 0;
+    for (const auto& ptr : ptrs) {
+        if (Ty2* result = cache.cast(std::to_address(ptr))) { out[count++] = result; }
+    }
+    return count;
+}
+
+// Same as `dynamicCastBatch`, but sets bit `i % 64` of `selected[i / 64]` if `ptrs[i]` is of kind `Ty2`
+template<typename Ty2, typename Range>
+void isKindOfBatch(const Range& ptrs, std::uint64_t* selected) {
+    detail::BatchCastCache<Ty2> cache;
+    std::size_t index = 0;
+    std::uint64_t bits = 0;
+    for (const auto& ptr : ptrs) {
+        bits |= std::uint64_t{cache.cast(std::to_address(ptr)) != nullptr} << (index % 64);
+        if (++index % 64 == 0) { *selected++ = std::exchange(bits, 0); }
+    }
+    if (index % 64 != 0) { *selected = bits; }
+}
+
+namespace detail {
+// Class whose reference a `typeSwitch` handler takes
+template<typename Func>
+struct HandlerArg : HandlerArg<decltype(&Func::operator())> {};
+template<typename Ret, typename Class, typename Arg>
+struct HandlerArg<Ret (Class::*)(Arg&)> {
+    using type = Arg;
+};
+template<typename Ret, typename Class, typename Arg>
+struct HandlerArg<Ret (Class::*)(Arg&) const> {
+    using type = Arg;
+};
+template<typename Ret, typename Arg>
+struct HandlerArg<Ret(Arg&)> {
+    using type = Arg;
+};
+template<typename Ret, typename Arg>
+struct HandlerArg<Ret (*)(Arg&)> {
+    using type = Arg;
+};
+
+template<typename Ty, typename... Funcs>
+class TypeSwitch {
+ private:
+    template<typename Func>
+    using Arg = typename HandlerArg<std::remove_cv_t<Func>>::type;
+
+    static constexpr std::size_t kCount = sizeof...(Funcs);
+    static constexpr std::size_t kCacheSize = 8;
+    static constexpr util::type_id kIds[] = {util::type_traits<Arg<Funcs>>::id()...};
+
+    static constexpr bool distinctIds() {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            for (std::size_t j = 0; j < i; ++j) {
+                if (kIds[i] == kIds[j]) { return false; }
+            }
+        }
+        return true;
+    }
+    static_assert(distinctIds(), "each class may have one handler only");
+
+ public:
+    using Result = std::common_type_t<std::invoke_result_t<Funcs&, Arg<Funcs>&>...>;
+
+ private:
+    // Handler index (`kCount` if none matches) and `this` adjustment for one most-derived class
+    struct Case {
+        std::size_t index = kCount;
+        std::ptrdiff_t offset = 0;
+    };
+
+    static inline std::atomic<const void*> vptrs_[kCacheSize]{};
+    static inline Case cases_[kCacheSize]{};
+    static inline std::atomic<std::size_t> count_{0};
+
+    template<std::size_t I>
+    static Result call(void* object, Funcs&... funcs) {
+        using Func = std::remove_reference_t<std::tuple_element_t<I, std::tuple<Funcs&...>>>;
+        return std::get<I>(std::tie(funcs...))(*static_cast<Arg<Func>*>(object));
+    }
+
+    static Result none(void*, Funcs&...) {
+        if constexpr (!std::is_void_v<Result>) { return Result{}; }
+    }
+
+    static constexpr auto kTable = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array<Result (*)(void*, Funcs&...), kCount + 1>{&call<Is>..., &none};
+    }(std::index_sequence_for<Funcs...>{});
+
+    // Through the recursion rather than the flattened table, which is empty until dynamic initialization and would
+    // leave a case without a handler cached for good
+    static Case resolve(const Ty* ptr) {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            if (const void* result = ptr->dynamicCast(kIds[i])) {
+                return {i, static_cast<const char*>(result) - reinterpret_cast<const char*>(ptr)};
+            }
+        }
+        return {};
+    }
+
+    static Case lookup(const Ty* ptr) {
+        const void* vptr = getVptr(ptr);
+        for (std::size_t i = 0; i < kCacheSize; ++i) {
+            if (vptrs_[i].load(std::memory_order_acquire) == vptr) { return cases_[i]; }
+        }
+        const Case found = resolve(ptr);
+        std::size_t n = count_.load(std::memory_order_relaxed);
+        if (n < kCacheSize && count_.compare_exchange_strong(n, n + 1, std::memory_order_relaxed)) {
+            cases_[n] = found;
+            vptrs_[n].store(vptr, std::memory_order_release);
+        }
+        return found;
+    }
+
+ public:
+    static Result dispatch(Ty* ptr, Funcs&... funcs) {
+        if (!ptr) { return kTable[kCount](nullptr, funcs...); }
+        const Case found = lookup(ptr);
+        auto* object = const_cast<char*>(reinterpret_cast<const char*>(ptr)) + found.offset;
+        return kTable[found.index](object, funcs...);
+    }
+};
+}  // namespace detail
+
+// Calls the first of `funcs` whose parameter, a reference to a class, `*ptr` is a kind of, and returns its result;
+// if none is, or `ptr` is null, returns a value-initialized result. The handler and the `this` adjustment are resolved
+// once per most-derived class and remembered for the set of handlers, so that a dispatch reads the vptr, finds it in
+// a small table, and makes one indirect call through a jump table generated at compile time. Handlers must take
+// distinct classes; the ones after a handler taking a base class are never called.
+template<typename Ty, typename... Funcs>
+auto typeSwitch(Ty* ptr, Funcs&&... funcs) {
+    return detail::TypeSwitch<Ty, std::remove_reference_t<Funcs>...>::dispatch(ptr, funcs...);
+}
+
 namespace detail {
 template<typename, typename...>
 struct dynamicCastImpl {};
@@ -103,6 +526,218 @@ struct dynamicCastImpl<Ty, Ty2, Tail...> {
         return ptr->Ty2::dynamicCast(id);
     }
 };
+
+template<typename... Ts>
+struct TypeList {};
+
+template<typename...>
+struct Concat {
+    using type = TypeList<>;
+};
+template<typename... Ts>
+struct Concat<TypeList<Ts...>> {
+    using type = TypeList<Ts...>;
+};
+template<typename... Ts, typename... Us, typename... Tail>
+struct Concat<TypeList<Ts...>, TypeList<Us...>, Tail...> : Concat<TypeList<Ts..., Us...>, Tail...> {};
+
+template<typename Ty, typename Paths>
+struct PrependToPaths;
+template<typename Ty, typename... Paths>
+struct PrependToPaths<Ty, TypeList<Paths...>> {
+    template<typename Path>
+    struct Prepend;
+    template<typename... Ts>
+    struct Prepend<TypeList<Ts...>> {
+        using type = TypeList<Ty, Ts...>;
+    };
+    using type = TypeList<typename Prepend<Paths>::type...>;
+};
+
+// All inheritance paths from `Ty` to its ancestors (`Ty` itself included), each one as `TypeList<Ty, ..., Ancestor>`
+template<typename Ty, typename = typename Ty::RttiBases>
+struct AncestorPaths;
+template<typename Base>
+struct BasePaths {
+    using type = typename AncestorPaths<Base>::type;
+};
+template<typename Base>
+struct BasePaths<AsIface<Base>> {
+    using type = TypeList<TypeList<Base>>;
+};
+template<typename Ty, typename... Bases>
+struct AncestorPaths<Ty, BaseList<Bases...>> {
+    using type = typename Concat<TypeList<TypeList<Ty>>,
+                                 typename PrependToPaths<Ty, typename BasePaths<Bases>::type>::type...>::type;
+};
+
+template<typename... Path>
+struct UpCastPath;
+template<typename Ty>
+struct UpCastPath<Ty> {
+    static const void* apply(const Ty* ptr) { return ptr; }
+};
+template<typename Ty, typename Next, typename... Tail>
+struct UpCastPath<Ty, Next, Tail...> {
+    static const void* apply(const Ty* ptr) { return UpCastPath<Next, Tail...>::apply(static_cast<const Next*>(ptr)); }
+};
+
+template<typename Path>
+struct PathTraits;
+template<typename Ty, typename... Tail>
+struct PathTraits<TypeList<Ty, Tail...>> {
+    using Ancestor = typename decltype((std::type_identity<Ty>{}, ..., std::type_identity<Tail>{}))::type;
+    static std::ptrdiff_t offset() {
+        // Pointer conversions between subobjects are not constant expressions, so the adjustment is measured on a
+        // fake (never dereferenced) object address, the same way KCL does it
+        const auto* ptr = reinterpret_cast<const Ty*>(std::uintptr_t{alignof(Ty)} << 8);
+        return static_cast<const char*>(UpCastPath<Ty, Tail...>::apply(ptr)) - reinterpret_cast<const char*>(ptr);
+    }
+};
+
+// Flattened ancestor table of `Ty`: ids of all ancestors (through primary bases, secondary bases and interfaces
+// alike) and the matching `this` adjustments, so that a cast to any of them, including a cross-cast between sibling
+// bases, is a single lookup. If an ancestor is reachable by several paths, the first one in declaration order wins.
+// Entries are placed by a perfect hash found at compile time: a window of the id bits indexes the table directly.
+// If no window separates the ids, the table is sorted by id and binary-searched instead. Offsets are stored in as
+// few bits as the size of `Ty` allows, so that with narrow ids an entry takes 4 or 8 bytes.
+template<typename Ty, typename Paths = typename AncestorPaths<Ty>::type>
+struct CastTable;
+template<typename Ty, typename... Paths>
+struct CastTable<Ty, TypeList<Paths...>> {
+    using Id = util::type_id::value_type;
+    using Offset = std::conditional_t<sizeof(Ty) <= INT16_MAX, std::int16_t, std::int32_t>;
+    static_assert(sizeof(Ty) <= INT32_MAX);
+
+    static constexpr std::size_t kPathCount = sizeof...(Paths);
+    static constexpr std::array<Id, kPathCount> kIds{
+        util::class_id<typename PathTraits<Paths>::Ancestor>::value.value()...};
+    static constexpr std::array<std::string_view, kPathCount> kNames{
+        util::type_traits<typename PathTraits<Paths>::Ancestor>::name()...};
+
+    // Whether an ancestor other than the class named `name` has the id `id`
+    static constexpr bool collides(Id id, std::string_view name) {
+        for (std::size_t path = 0; path < kPathCount; ++path) {
+            if (kIds[path] == id && kNames[path] != name) { return true; }
+        }
+        return false;
+    }
+
+    static constexpr bool distinctIds() {
+        for (std::size_t path = 0; path < kPathCount; ++path) {
+            if (collides(kIds[path], kNames[path])) { return false; }
+        }
+        return true;
+    }
+    static_assert(distinctIds(), "two ancestors have the same type id: use wider ids (VRC_TYPE_ID_BITS)");
+
+    struct Entries {
+        std::array<Id, kPathCount> ids{};
+        std::array<std::size_t, kPathCount> paths{};
+        std::size_t size = 0;
+    };
+
+    static constexpr Entries sortEntries() {
+        const std::array<Id, kPathCount>& ids = kIds;
+        Entries entries;
+        for (std::size_t path = 0; path < kPathCount; ++path) {
+            std::size_t pos = 0;
+            while (pos < entries.size && entries.ids[pos] < ids[path]) { ++pos; }
+            if (pos < entries.size && entries.ids[pos] == ids[path]) { continue; }
+            for (std::size_t i = entries.size; i > pos; --i) {
+                entries.ids[i] = entries.ids[i - 1];
+                entries.paths[i] = entries.paths[i - 1];
+            }
+            entries.ids[pos] = ids[path];
+            entries.paths[pos] = path;
+            ++entries.size;
+        }
+        return entries;
+    }
+
+    static constexpr Entries kEntries = sortEntries();
+    static constexpr std::size_t kSize = kEntries.size;
+
+    // Slot of an id is `(id >> shift) & (2^bits - 1)`
+    struct Hash {
+        bool perfect = false;
+        unsigned bits = 0;
+        unsigned shift = 0;
+    };
+
+    static constexpr unsigned kMinBits = std::bit_width(kSize - 1);
+    static constexpr unsigned kMaxBits = kMinBits + 3;
+
+    static constexpr Hash findHash() {
+        for (unsigned bits = kMinBits; bits <= kMaxBits; ++bits) {
+            for (unsigned shift = 0; shift + bits <= VRC_TYPE_ID_BITS; ++shift) {
+                std::array<bool, std::size_t{1} << kMaxBits> taken{};
+                bool perfect = true;
+                for (std::size_t i = 0; i < kSize && perfect; ++i) {
+                    const std::size_t slot = (kEntries.ids[i] >> shift) & ((std::size_t{1} << bits) - 1);
+                    perfect = !taken[slot];
+                    taken[slot] = true;
+                }
+                if (perfect) { return {true, bits, shift}; }
+            }
+        }
+        return {};
+    }
+
+    static constexpr Hash kHash = findHash();
+    static constexpr std::size_t kSlots = kHash.perfect ? std::size_t{1} << kHash.bits : kSize;
+
+    struct Entry {
+        Id id;
+        Offset offset;
+    };
+
+    static std::array<Entry, kSlots> makeTable() {
+        const std::array<std::ptrdiff_t, kPathCount> offsets{PathTraits<Paths>::offset()...};
+        // Empty slots hold an id stored in another slot, which no lookup that lands on them can match
+        std::array<Entry, kSlots> table;
+        table.fill({kEntries.ids[0], 0});
+        for (std::size_t i = 0; i < kSize; ++i) {
+            const std::size_t slot = kHash.perfect ? (kEntries.ids[i] >> kHash.shift) & (kSlots - 1) : i;
+            table[slot] = {kEntries.ids[i], static_cast<Offset>(offsets[kEntries.paths[i]])};
+        }
+        return table;
+    }
+
+    // Zero until dynamic initialization, so that earlier casts fail instead of returning a wrong pointer
+    inline static const std::array<Entry, kSlots> table = makeTable();
+
+    static const void* find(const Ty* ptr, util::type_id id) {
+        const Id value = id.value();
+        std::size_t pos = 0;
+        if constexpr (kHash.perfect) {
+            pos = (value >> kHash.shift) & (kSlots - 1);
+        } else {
+            // Branchless binary search
+            for (std::size_t len = kSize; len > 1; len -= len / 2) {
+                pos += kEntries.ids[pos + len / 2] <= value ? len / 2 : 0;
+            }
+        }
+        const Entry& entry = table[pos];
+        return entry.id == value ? reinterpret_cast<const char*>(ptr) + entry.offset : nullptr;
+    }
+};
+
+// Keeps `CastTable` from being instantiated inside the class body, before the class name is declared
+template<typename Ty>
+const void* findInCastTable(const Ty* ptr, util::type_id id) {
+    return CastTable<Ty>::find(ptr, id);
+}
+
+template<typename Ty2, typename Ty>
+constexpr bool distinctFromAncestors() {
+    using Source = std::remove_cv_t<Ty>;
+    if constexpr (requires { typename Source::RttiBases; }) {
+        return !CastTable<Source>::collides(util::type_traits<Ty2>::id().value(), util::type_traits<Ty2>::name());
+    } else {
+        return true;
+    }
+}
 }  // namespace detail
 
 }  // namespace vrc
@@ -1,11 +1,22 @@
 #pragma once
 
 #include <array>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <string_view>
 #include <type_traits>
 
+// Width of type ids in bits: 16, 32 or 64. Narrower ids make the cast tables smaller, at a higher risk of two types
+// hashing to the same id; collisions between the ancestors of a class, or between a cast target and the ancestors of
+// the static type, are caught at compile time.
+#if !defined(VRC_TYPE_ID_BITS)
+#    define VRC_TYPE_ID_BITS 64
+#endif
+static_assert(VRC_TYPE_ID_BITS == 16 || VRC_TYPE_ID_BITS == 32 || VRC_TYPE_ID_BITS == 64,
+              "VRC_TYPE_ID_BITS must be 16, 32 or 64");
+
 #define VRC_DECLARE_CLASS_NAME(ty) \
     template<> \
     struct util::class_name<ty> { \
@@ -26,17 +37,21 @@ constexpr std::array<char, N - 1> make_class_name(const char (&name)[N]) {
 }
 
 class type_id {
+ public:
+    using value_type = std::conditional_t<VRC_TYPE_ID_BITS == 16, std::uint16_t,
+                                          std::conditional_t<VRC_TYPE_ID_BITS == 32, std::uint32_t, std::uint64_t>>;
+
  private:
-    std::uint64_t id_ = 0;
+    value_type id_ = 0;
 
  public:
     constexpr type_id() = default;
-    explicit constexpr type_id(std::uint64_t id) : id_(id) {}
+    explicit constexpr type_id(value_type id) : id_(id) {}
 
-    std::uint64_t value() const { return id_; }
+    constexpr value_type value() const { return id_; }
 
-    bool operator==(const type_id& type) const { return id_ == type.id_; }
-    bool operator!=(const type_id& type) const { return id_ != type.id_; }
+    constexpr bool operator==(const type_id& type) const { return id_ == type.id_; }
+    constexpr bool operator!=(const type_id& type) const { return id_ != type.id_; }
 };
 
 constexpr std::uint64_t calc_hash64(const char* data, std::size_t size) {
@@ -48,7 +63,12 @@ constexpr std::uint64_t calc_hash64(const char* data, std::size_t size) {
     std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(size) * mul);
     for (const char* end8 = data + (size & ~7); p8 != end8; p8 += 8) {
         std::uint64_t a = 0;
-        for (const char* p = p8 + 8; p != p8; --p) { a = (a << 8) + static_cast<std::uint8_t>(*(p - 1)); }
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            // Same value as the loop below, read at once when hashing names at run time
+            std::memcpy(&a, p8, sizeof(a));
+        } else {
+            for (const char* p = p8 + 8; p != p8; --p) { a = (a << 8) + static_cast<std::uint8_t>(*(p - 1)); }
+        }
         hash = (hash ^ shift_mix(a * mul) * mul) * mul;
     }
     if (size & 7) {
@@ -59,16 +79,24 @@ constexpr std::uint64_t calc_hash64(const char* data, std::size_t size) {
     return shift_mix(shift_mix(hash) * mul);
 }
 
+// Folds a 64-bit hash down to the width of `type_id`
+constexpr type_id::value_type fold_hash(std::uint64_t hash) {
+    if constexpr (VRC_TYPE_ID_BITS < 64) { hash ^= hash >> 32; }
+    if constexpr (VRC_TYPE_ID_BITS < 32) { hash ^= hash >> 16; }
+    return static_cast<type_id::value_type>(hash);
+}
+
 template<typename Ty>
 struct class_id {
-    static constexpr type_id value{calc_hash64(class_name<Ty>::value.data(), class_name<Ty>::value.size())};
+    static constexpr type_id value{
+        fold_hash(calc_hash64(class_name<Ty>::value.data(), class_name<Ty>::value.size()))};
 };
 
 template<typename Ty>
 struct type_traits {
     using type = std::remove_cv_t<Ty>;
-    static type_id id() { return class_id<type>::value; }
-    static std::string_view name() { return {class_name<type>::value.data(), class_name<type>::value.size()}; }
+    static constexpr type_id id() { return class_id<type>::value; }
+    static constexpr std::string_view name() { return {class_name<type>::value.data(), class_name<type>::value.size()}; }
 };
 
 }  // namespace util
@@ -76,5 +104,5 @@ struct type_traits {
 
 template<>
 struct std::hash<util::type_id> {
-    std::size_t operator()(util::type_id k) const { return std::hash<std::uint64_t>{}(k.value()); }
+    std::size_t operator()(util::type_id k) const { return std::hash<util::type_id::value_type>{}(k.value()); }
 };
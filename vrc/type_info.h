@@ -0,0 +1,199 @@
+#pragma once
+
+#include "type_id.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+
+// Width of the ancestor bitsets; types registered past this count are tested with the ancestor tables
+#if !defined(VRC_ANCESTOR_BITS)
+#    define VRC_ANCESTOR_BITS 256
+#endif
+
+static_assert(VRC_ANCESTOR_BITS > 0 && VRC_ANCESTOR_BITS % 64 == 0, "VRC_ANCESTOR_BITS must be a multiple of 64");
+
+namespace vrc {
+
+struct RttiBase;
+
+namespace detail {
+struct TypeRegistrar;
+}  // namespace detail
+
+// Run-time description of a class declared with `VRC_IMPLEMENT_DYNAMIC_CAST`. All descriptors are constant data,
+// registered during static initialization. The forest formed by primary (first listed) bases is numbered in
+// depth-first order, so that every class gets an interval [pre, post] spanning its primary-derived classes; this is
+// done once, by the first interval test after classes were registered, rather than on every registration. Each
+// numbering is a new table published atomically, so that interval tests running meanwhile keep using the old one.
+// Registration also gives each class a bit, and each class a set of the bits of all its ancestors.
+// Casts made from other static initializers may see types that are not registered yet.
+class TypeInfo {
+ private:
+    static constexpr std::size_t kAncestorWords = VRC_ANCESTOR_BITS / 64;
+
+    friend struct detail::TypeRegistrar;
+
+    std::string_view name_;
+    util::type_id id_;
+    TypeInfo* const* bases_ = nullptr;
+    std::size_t base_count_ = 0;
+    RttiBase* (*create_)() = nullptr;
+
+    // Filled in by registration; until then the type has no interval and is treated as secondary. `secondary_` may
+    // be set later by a derived class registering while casts read it.
+    bool registered_ = false;
+    std::atomic<bool> secondary_{true};
+    std::uint32_t index_ = std::numeric_limits<std::uint32_t>::max();
+    TypeInfo* first_child_ = nullptr;
+    TypeInfo* next_sibling_ = nullptr;
+    std::size_t bit_word_ = 0;
+    std::uint64_t bit_mask_ = 0;
+    std::uint64_t ancestors_[kAncestorWords] = {};
+
+ public:
+    constexpr TypeInfo(std::string_view name, util::type_id id, TypeInfo* const* bases, std::size_t base_count,
+                       RttiBase* (*create)() = nullptr)
+        : name_(name), id_(id), bases_(bases), base_count_(base_count), create_(create) {}
+    TypeInfo(const TypeInfo&) = delete;
+    TypeInfo& operator=(const TypeInfo&) = delete;
+
+    std::string_view name() const { return name_; }
+    util::type_id id() const { return id_; }
+    std::span<TypeInfo* const> bases() const { return {bases_, base_count_}; }
+
+    // Calls `func(const TypeInfo&)` for this class and then for its ancestors, depth-first in declaration order; an
+    // ancestor reachable through several paths is visited once per path
+    template<typename Func>
+    void forEachAncestor(Func&& func) const {
+        func(*this);
+        for (const TypeInfo* base : bases()) { base->forEachAncestor(func); }
+    }
+
+    // False for abstract classes and classes that are not default-constructible
+    bool isConstructible() const { return create_ != nullptr; }
+
+    // Allocates a default-constructed object of this class with `new`, or returns nullptr if not constructible. The
+    // result points to the `RttiBase` reached through primary bases, and the object is deleted through it.
+    RttiBase* create() const { return create_ ? create_() : nullptr; }
+
+    // True if some registered class derives from this one through a base other than its primary one, in which
+    // case `isPrimaryBaseOf` can't tell all the derived classes
+    bool isSecondaryBase() const { return secondary_.load(std::memory_order_relaxed); }
+
+    // True if `type` is this class or derives from it through primary bases only, with a single unsigned compare
+    // once the forest is numbered
+    bool isPrimaryBaseOf(const TypeInfo& type) const;
+
+    // False if the type was registered after all `VRC_ANCESTOR_BITS` bits were given out
+    bool hasAncestorBit() const { return bit_mask_ != 0; }
+
+    // True if `type` is this class or derives from it; valid only if `hasAncestorBit()`
+    bool isBaseOf(const TypeInfo& type) const { return (type.ancestors_[bit_word_] & bit_mask_) != 0; }
+};
+
+namespace detail {
+// Intervals of the primary-base forest, indexed by registration order, for the first `count` registered classes
+struct TypeNumbering {
+    struct Interval {
+        std::uint32_t pre;
+        std::uint32_t post;
+    };
+
+    std::size_t count;
+    std::unique_ptr<Interval[]> intervals;
+};
+
+struct TypeRegistrar {
+    // Held while registering and while walking the forest, as a shared library may register classes on one thread
+    // while another looks them up
+    static inline constinit std::mutex mutex;
+    static inline constinit TypeInfo* first_root = nullptr;
+    // Increased with release order once a class is linked into the forest
+    static inline constinit std::atomic<std::size_t> type_count{0};
+    // Latest numbering, published with release order. Replaced ones are never freed, as interval tests may still
+    // read them; there is one per batch of registrations followed by a cast.
+    static inline constinit std::atomic<const TypeNumbering*> numbering{nullptr};
+
+    explicit TypeRegistrar(TypeInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+        registerType(info);
+    }
+
+    static void registerType(TypeInfo& info) {
+        if (info.registered_) { return; }
+        info.registered_ = true;
+        info.secondary_.store(false, std::memory_order_relaxed);
+        for (TypeInfo* base : info.bases()) { registerType(*base); }
+        const std::size_t bit = type_count.load(std::memory_order_relaxed);
+        info.index_ = static_cast<std::uint32_t>(bit);
+        if (bit < VRC_ANCESTOR_BITS) {
+            info.bit_word_ = bit / 64;
+            info.bit_mask_ = std::uint64_t{1} << (bit % 64);
+            info.ancestors_[info.bit_word_] = info.bit_mask_;
+        }
+        for (const TypeInfo* base : info.bases()) {
+            for (std::size_t i = 0; i < TypeInfo::kAncestorWords; ++i) { info.ancestors_[i] |= base->ancestors_[i]; }
+        }
+        TypeInfo*& first_sibling = info.base_count_ ? info.bases_[0]->first_child_ : first_root;
+        info.next_sibling_ = first_sibling;
+        first_sibling = &info;
+        for (TypeInfo* base : info.bases().subspan(info.base_count_ ? 1 : 0)) { markSecondary(*base); }
+        type_count.store(bit + 1, std::memory_order_release);
+    }
+
+    // Returns the numbering of all the classes registered so far, numbering the forest anew if classes were
+    // registered since it was last numbered
+    static const TypeNumbering& numberForest() {
+        const TypeNumbering* current = numbering.load(std::memory_order_acquire);
+        if (current && current->count == type_count.load(std::memory_order_acquire)) { return *current; }
+        std::lock_guard<std::mutex> lock(mutex);
+        current = numbering.load(std::memory_order_relaxed);
+        const std::size_t count = type_count.load(std::memory_order_relaxed);
+        if (current && current->count == count) { return *current; }
+        auto* next = new TypeNumbering{count, std::make_unique<TypeNumbering::Interval[]>(count)};
+        std::uint32_t counter = 0;
+        for (TypeInfo* root = first_root; root; root = root->next_sibling_) { number(*root, next->intervals, counter); }
+        numbering.store(next, std::memory_order_release);
+        return *next;
+    }
+
+    // Calls `func(const TypeInfo&)` for every registered class, in depth-first order of the primary-base forest
+    template<typename Func>
+    static void forEachType(Func&& func, const TypeInfo* first = first_root) {
+        for (const TypeInfo* info = first; info; info = info->next_sibling_) {
+            func(*info);
+            forEachType(func, info->first_child_);
+        }
+    }
+
+    static void markSecondary(TypeInfo& info) {
+        info.secondary_.store(true, std::memory_order_relaxed);
+        for (TypeInfo* base : info.bases()) { markSecondary(*base); }
+    }
+
+    static void number(const TypeInfo& info, const std::unique_ptr<TypeNumbering::Interval[]>& intervals,
+                       std::uint32_t& counter) {
+        TypeNumbering::Interval& interval = intervals[info.index_];
+        interval.pre = counter++;
+        for (const TypeInfo* child = info.first_child_; child; child = child->next_sibling_) {
+            number(*child, intervals, counter);
+        }
+        interval.post = counter - 1;
+    }
+};
+}  // namespace detail
+
+inline bool TypeInfo::isPrimaryBaseOf(const TypeInfo& type) const {
+    const detail::TypeNumbering& numbering = detail::TypeRegistrar::numberForest();
+    if (index_ >= numbering.count || type.index_ >= numbering.count) { return false; }
+    const auto [pre, post] = numbering.intervals[index_];
+    return numbering.intervals[type.index_].pre - pre <= post - pre;
+}
+
+}  // namespace vrc
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "type_id.h"
+#include "type_info.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace vrc {
+
+// Run-time lookup of registered classes by id or name, e.g. to construct the object a serialized message names.
+// The index is a perfect hash over the ids of all registered classes: the id picks a bucket, and the seed of the
+// bucket sends each of its ids to a slot of its own, so a lookup reads one seed and one slot and compares one id.
+// Names are looked up by their id, which is a hash of the name. The set of classes is only known once static
+// initialization is over, so the index is built by the first lookup, and again by the first lookup after more
+// classes get registered (e.g. by a shared library loaded later).
+class TypeRegistry {
+ private:
+    struct Index {
+        std::size_t type_count = 0;
+        std::size_t bucket_mask = 0;
+        std::size_t slot_mask = 0;
+        std::vector<std::uint32_t> seeds;
+        std::vector<const TypeInfo*> slots;
+        // Classes whose id another class already has, only found by name
+        std::vector<const TypeInfo*> shadowed;
+    };
+
+    static constexpr std::uint32_t kMaxSeed = 1 << 16;
+
+    static inline std::vector<std::unique_ptr<const Index>> indexes_;
+    static inline std::atomic<const Index*> current_{nullptr};
+
+    static std::uint64_t mix(std::uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    static std::size_t bucketOf(const Index& index, util::type_id id) { return mix(id.value()) & index.bucket_mask; }
+
+    static std::size_t slotOf(const Index& index, util::type_id id, std::uint32_t seed) {
+        return mix(id.value() + (std::uint64_t{seed} + 1) * 0x9e3779b97f4a7c15ULL) & index.slot_mask;
+    }
+
+    // Gives the buckets seeds that place all `types` in distinct slots, largest buckets first; false if some bucket
+    // finds no such seed
+    static bool place(Index& index, const std::vector<const TypeInfo*>& types) {
+        std::vector<std::vector<const TypeInfo*>> buckets(index.bucket_mask + 1);
+        for (const TypeInfo* type : types) { buckets[bucketOf(index, type->id())].push_back(type); }
+        std::vector<std::size_t> order(buckets.size());
+        for (std::size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        std::vector<std::size_t> taken;
+        for (std::size_t bucket : order) {
+            if (buckets[bucket].empty()) { break; }
+            std::uint32_t seed = 0;
+            for (; seed < kMaxSeed; ++seed) {
+                taken.clear();
+                for (const TypeInfo* type : buckets[bucket]) {
+                    const std::size_t slot = slotOf(index, type->id(), seed);
+                    if (index.slots[slot] || std::find(taken.begin(), taken.end(), slot) != taken.end()) { break; }
+                    taken.push_back(slot);
+                }
+                if (taken.size() == buckets[bucket].size()) { break; }
+            }
+            if (seed == kMaxSeed) { return false; }
+            index.seeds[bucket] = seed;
+            for (std::size_t i = 0; i < taken.size(); ++i) { index.slots[taken[i]] = buckets[bucket][i]; }
+        }
+        return true;
+    }
+
+    // Holds the registration mutex, so that the forest doesn't change while it is walked and `indexes_` while it grows
+    static const Index* build() {
+        std::lock_guard<std::mutex> lock(detail::TypeRegistrar::mutex);
+        const std::size_t type_count = detail::TypeRegistrar::type_count.load(std::memory_order_relaxed);
+        if (const Index* index = current_.load(std::memory_order_acquire); index && index->type_count == type_count) {
+            return index;
+        }
+
+        auto index = std::make_unique<Index>();
+        index->type_count = type_count;
+        std::vector<const TypeInfo*> types;
+        detail::TypeRegistrar::forEachType([&](const TypeInfo& type) { types.push_back(&type); });
+        std::stable_sort(types.begin(), types.end(),
+                         [](const TypeInfo* a, const TypeInfo* b) { return a->id().value() < b->id().value(); });
+        std::vector<const TypeInfo*> unique;
+        for (const TypeInfo* type : types) {
+            if (!unique.empty() && unique.back()->id() == type->id()) {
+                index->shadowed.push_back(type);
+            } else {
+                unique.push_back(type);
+            }
+        }
+
+        // About two ids per bucket and one to two slots per id; a table twice as large is tried if seeds run out
+        for (std::size_t slots = std::bit_ceil(std::max<std::size_t>(unique.size(), 1));; slots *= 2) {
+            index->slot_mask = slots - 1;
+            index->bucket_mask = std::max<std::size_t>(slots / 2, 1) - 1;
+            index->seeds.assign(index->bucket_mask + 1, 0);
+            index->slots.assign(slots, nullptr);
+            if (place(*index, unique)) { break; }
+        }
+
+        const Index* result = index.get();
+        indexes_.push_back(std::move(index));
+        current_.store(result, std::memory_order_release);
+        return result;
+    }
+
+    static const Index& index() {
+        const Index* index = current_.load(std::memory_order_acquire);
+        if (!index || index->type_count != detail::TypeRegistrar::type_count.load(std::memory_order_acquire)) {
+            index = build();
+        }
+        return *index;
+    }
+
+ public:
+    static const TypeInfo* find(util::type_id id) {
+        const Index& index = TypeRegistry::index();
+        const TypeInfo* type = index.slots[slotOf(index, id, index.seeds[bucketOf(index, id)])];
+        return type && type->id() == id ? type : nullptr;
+    }
+
+    static const TypeInfo* find(std::string_view name) {
+        const util::type_id id{util::fold_hash(util::calc_hash64(name.data(), name.size()))};
+        if (const TypeInfo* type = find(id); type && type->name() == name) { return type; }
+        for (const TypeInfo* type : index().shadowed) {
+            if (type->name() == name) { return type; }
+        }
+        return nullptr;
+    }
+
+    // Same as `find(name)->create()`, or nullptr if there is no such class
+    static RttiBase* create(std::string_view name) {
+        const TypeInfo* type = find(name);
+        return type ? type->create() : nullptr;
+    }
+
+    // Calls `func(const TypeInfo&)` for every registered class, outside the registration lock, so `func` may look up
+    // classes itself
+    template<typename Func>
+    static void forEach(Func&& func) {
+        std::vector<const TypeInfo*> types;
+        {
+            std::lock_guard<std::mutex> lock(detail::TypeRegistrar::mutex);
+            detail::TypeRegistrar::forEachType([&](const TypeInfo& type) { types.push_back(&type); });
+        }
+        for (const TypeInfo* type : types) { func(*type); }
+    }
+
+    static std::size_t size() { return detail::TypeRegistrar::type_count.load(std::memory_order_acquire); }
+};
+
+}  // namespace vrc